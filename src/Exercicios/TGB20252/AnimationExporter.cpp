@@ -0,0 +1,536 @@
+#include "AnimationExporter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+namespace {
+// Colours are binned at 5 bits per channel for the histogram and the inverse colour map
+const int kBins = 32 * 32 * 32;
+const int kPaletteSize = 256;
+// Histograms look at every other pixel in both directions
+const int kSampleStep = 2;
+
+inline int binIndex(int b, int g, int r) {
+    return ((r >> 3) << 10) | ((g >> 3) << 5) | (b >> 3);
+}
+
+inline int binChannel(int bin, int channel) {
+    return (bin >> (channel * 5)) & 31;
+}
+
+struct ColorHistogram {
+    std::vector<uint32_t> count;
+    std::vector<uint64_t> sum;
+
+    ColorHistogram() : count(kBins, 0), sum(kBins * 3, 0) {}
+
+    void add(const cv::Mat& frame) {
+        for (int y = 0; y < frame.rows; y += kSampleStep) {
+            const cv::Vec3b* row = frame.ptr<cv::Vec3b>(y);
+            for (int x = 0; x < frame.cols; x += kSampleStep) {
+                int bin = binIndex(row[x][0], row[x][1], row[x][2]);
+                ++count[bin];
+                sum[bin * 3] += row[x][0];
+                sum[bin * 3 + 1] += row[x][1];
+                sum[bin * 3 + 2] += row[x][2];
+            }
+        }
+    }
+
+    void merge(const ColorHistogram& other) {
+        for (int i = 0; i < kBins; ++i) {
+            count[i] += other.count[i];
+        }
+        for (int i = 0; i < kBins * 3; ++i) {
+            sum[i] += other.sum[i];
+        }
+    }
+};
+
+struct Box {
+    std::vector<int> bins;
+    uint64_t pixels{0};
+    int axis{0};
+    int range{0};
+};
+
+void measure(Box& box) {
+    int lo[3] = {31, 31, 31};
+    int hi[3] = {0, 0, 0};
+    for (int bin : box.bins) {
+        for (int c = 0; c < 3; ++c) {
+            lo[c] = std::min(lo[c], binChannel(bin, c));
+            hi[c] = std::max(hi[c], binChannel(bin, c));
+        }
+    }
+    box.axis = 0;
+    for (int c = 1; c < 3; ++c) {
+        if (hi[c] - lo[c] > hi[box.axis] - lo[box.axis]) {
+            box.axis = c;
+        }
+    }
+    box.range = hi[box.axis] - lo[box.axis];
+}
+
+// Median cut over the binned histogram: repeatedly split the box with the most pixels times extent
+// at the pixel-weighted median of its widest channel
+std::vector<cv::Vec3b> medianCut(const ColorHistogram& histogram) {
+    std::vector<Box> boxes(1);
+    for (int bin = 0; bin < kBins; ++bin) {
+        if (histogram.count[bin] > 0) {
+            boxes[0].bins.push_back(bin);
+            boxes[0].pixels += histogram.count[bin];
+        }
+    }
+    if (boxes[0].bins.empty()) {
+        return {cv::Vec3b(0, 0, 0)};
+    }
+    measure(boxes[0]);
+
+    while (static_cast<int>(boxes.size()) < kPaletteSize) {
+        int best = -1;
+        uint64_t bestScore = 0;
+        for (int i = 0; i < static_cast<int>(boxes.size()); ++i) {
+            uint64_t score = boxes[i].pixels * static_cast<uint64_t>(boxes[i].range);
+            if (boxes[i].bins.size() > 1 && score > bestScore) {
+                best = i;
+                bestScore = score;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+
+        Box& box = boxes[best];
+        int axis = box.axis;
+        std::sort(box.bins.begin(), box.bins.end(),
+                  [axis](int a, int b) { return binChannel(a, axis) < binChannel(b, axis); });
+        uint64_t half = box.pixels / 2;
+        uint64_t running = 0;
+        size_t split = 1;
+        for (; split < box.bins.size() - 1; ++split) {
+            running += histogram.count[box.bins[split - 1]];
+            if (running >= half) {
+                break;
+            }
+        }
+
+        Box upper;
+        upper.bins.assign(box.bins.begin() + split, box.bins.end());
+        box.bins.resize(split);
+        box.pixels = upper.pixels = 0;
+        for (int bin : box.bins) {
+            box.pixels += histogram.count[bin];
+        }
+        for (int bin : upper.bins) {
+            upper.pixels += histogram.count[bin];
+        }
+        measure(box);
+        measure(upper);
+        boxes.push_back(std::move(upper));
+    }
+
+    std::vector<cv::Vec3b> palette;
+    palette.reserve(boxes.size());
+    for (const auto& box : boxes) {
+        uint64_t total[3] = {0, 0, 0};
+        for (int bin : box.bins) {
+            for (int c = 0; c < 3; ++c) {
+                total[c] += histogram.sum[bin * 3 + c];
+            }
+        }
+        uint64_t n = std::max<uint64_t>(1, box.pixels);
+        palette.emplace_back(static_cast<uchar>(total[0] / n), static_cast<uchar>(total[1] / n),
+                             static_cast<uchar>(total[2] / n));
+    }
+    return palette;
+}
+
+// Nearest palette entry for every 5-bit bin, so quantizing a pixel is one table load. The distance
+// loop runs over structure-of-arrays palette channels and vectorizes; the argmin stays scalar
+std::vector<uint8_t> buildInverseMap(const std::vector<cv::Vec3b>& palette) {
+    int n = static_cast<int>(palette.size());
+    std::vector<int> pb(n), pg(n), pr(n);
+    for (int i = 0; i < n; ++i) {
+        pb[i] = palette[i][0];
+        pg[i] = palette[i][1];
+        pr[i] = palette[i][2];
+    }
+
+    std::vector<uint8_t> lut(kBins);
+    cv::parallel_for_(cv::Range(0, 32), [&](const cv::Range& range) {
+        std::vector<int> distance(n);
+        for (int r5 = range.start; r5 < range.end; ++r5) {
+            int r = (r5 << 3) + 4;
+            for (int g5 = 0; g5 < 32; ++g5) {
+                int g = (g5 << 3) + 4;
+                for (int b5 = 0; b5 < 32; ++b5) {
+                    int b = (b5 << 3) + 4;
+                    for (int i = 0; i < n; ++i) {
+                        int db = pb[i] - b;
+                        int dg = pg[i] - g;
+                        int dr = pr[i] - r;
+                        distance[i] = db * db + dg * dg + dr * dr;
+                    }
+                    int best = 0;
+                    for (int i = 1; i < n; ++i) {
+                        if (distance[i] < distance[best]) {
+                            best = i;
+                        }
+                    }
+                    lut[(r5 << 10) | (g5 << 5) | b5] = static_cast<uint8_t>(best);
+                }
+            }
+        }
+    });
+    return lut;
+}
+
+// Floyd-Steinberg with errors kept at 16x in two row buffers
+void quantize(const cv::Mat& frame, const std::vector<cv::Vec3b>& palette, const std::vector<uint8_t>& lut,
+              bool dither, cv::Mat& indices) {
+    indices.create(frame.size(), CV_8UC1);
+    if (!dither) {
+        for (int y = 0; y < frame.rows; ++y) {
+            const cv::Vec3b* src = frame.ptr<cv::Vec3b>(y);
+            uint8_t* dst = indices.ptr<uint8_t>(y);
+            for (int x = 0; x < frame.cols; ++x) {
+                dst[x] = lut[binIndex(src[x][0], src[x][1], src[x][2])];
+            }
+        }
+        return;
+    }
+
+    int width = frame.cols;
+    std::vector<int> current((width + 2) * 3, 0);
+    std::vector<int> next((width + 2) * 3, 0);
+    for (int y = 0; y < frame.rows; ++y) {
+        const cv::Vec3b* src = frame.ptr<cv::Vec3b>(y);
+        uint8_t* dst = indices.ptr<uint8_t>(y);
+        std::fill(next.begin(), next.end(), 0);
+        for (int x = 0; x < width; ++x) {
+            const int* error = &current[(x + 1) * 3];
+            int value[3];
+            for (int c = 0; c < 3; ++c) {
+                value[c] = std::min(255, std::max(0, src[x][c] + error[c] / 16));
+            }
+            uint8_t index = lut[binIndex(value[0], value[1], value[2])];
+            dst[x] = index;
+            for (int c = 0; c < 3; ++c) {
+                int e = value[c] - palette[index][c];
+                current[(x + 2) * 3 + c] += e * 7;
+                next[x * 3 + c] += e * 3;
+                next[(x + 1) * 3 + c] += e * 5;
+                next[(x + 2) * 3 + c] += e;
+            }
+        }
+        std::swap(current, next);
+    }
+}
+
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>& out) : out(out) {}
+
+    void put(int code, int size) {
+        buffer |= static_cast<uint32_t>(code) << bits;
+        bits += size;
+        while (bits >= 8) {
+            out.push_back(static_cast<uint8_t>(buffer & 0xFF));
+            buffer >>= 8;
+            bits -= 8;
+        }
+    }
+
+    void flush() {
+        if (bits > 0) {
+            out.push_back(static_cast<uint8_t>(buffer & 0xFF));
+        }
+        buffer = 0;
+        bits = 0;
+    }
+
+private:
+    std::vector<uint8_t>& out;
+    uint32_t buffer{0};
+    int bits{0};
+};
+
+// GIF LZW with 8-bit minimum code size; the string table is an open-addressed hash on
+// (prefix code, next index), reset with a clear code whenever the 12-bit code space fills up
+void lzwEncode(const cv::Mat& indices, std::vector<uint8_t>& out) {
+    const int minCodeSize = 8;
+    const int clearCode = 1 << minCodeSize;
+    const int endCode = clearCode + 1;
+    const int hashBits = 13;
+    const int hashSize = 1 << hashBits;
+
+    std::vector<int32_t> keys(hashSize);
+    std::vector<int16_t> codes(hashSize);
+    std::vector<uint8_t> packed;
+    packed.reserve(indices.total() / 2);
+    BitWriter bits(packed);
+
+    int codeSize = minCodeSize + 1;
+    int maxCode = endCode;
+    std::fill(keys.begin(), keys.end(), -1);
+    bits.put(clearCode, codeSize);
+
+    int prefix = -1;
+    for (int y = 0; y < indices.rows; ++y) {
+        const uint8_t* row = indices.ptr<uint8_t>(y);
+        for (int x = 0; x < indices.cols; ++x) {
+            int value = row[x];
+            if (prefix < 0) {
+                prefix = value;
+                continue;
+            }
+            int32_t key = (prefix << 8) | value;
+            uint32_t slot = (static_cast<uint32_t>(key) * 2654435761u) >> (32 - hashBits);
+            while (keys[slot] != -1 && keys[slot] != key) {
+                slot = (slot + 1) & (hashSize - 1);
+            }
+            if (keys[slot] == key) {
+                prefix = codes[slot];
+                continue;
+            }
+
+            bits.put(prefix, codeSize);
+            keys[slot] = key;
+            codes[slot] = static_cast<int16_t>(++maxCode);
+            if (maxCode >= (1 << codeSize)) {
+                ++codeSize;
+            }
+            if (maxCode == 4095) {
+                bits.put(clearCode, codeSize);
+                std::fill(keys.begin(), keys.end(), -1);
+                codeSize = minCodeSize + 1;
+                maxCode = endCode;
+            }
+            prefix = value;
+        }
+    }
+    // The decoder adds one more entry after reading the last code (unless it is the first code after
+    // a clear) and widens if that fills the current width, so the end code goes out at its width
+    int endCodeSize = codeSize;
+    if (prefix >= 0) {
+        bits.put(prefix, codeSize);
+        if (maxCode > endCode && maxCode + 1 == (1 << codeSize) && codeSize < 12) {
+            ++endCodeSize;
+        }
+    }
+    bits.put(endCode, endCodeSize);
+    bits.flush();
+
+    out.push_back(static_cast<uint8_t>(minCodeSize));
+    for (size_t offset = 0; offset < packed.size(); offset += 255) {
+        size_t length = std::min<size_t>(255, packed.size() - offset);
+        out.push_back(static_cast<uint8_t>(length));
+        out.insert(out.end(), packed.begin() + offset, packed.begin() + offset + length);
+    }
+    out.push_back(0);
+}
+
+void put16(std::vector<uint8_t>& out, int value) {
+    out.push_back(static_cast<uint8_t>(value & 0xFF));
+    out.push_back(static_cast<uint8_t>((value >> 8) & 0xFF));
+}
+
+// Always 256 entries (size field 7) so local and global tables look the same
+void putColorTable(std::vector<uint8_t>& out, const std::vector<cv::Vec3b>& palette) {
+    for (int i = 0; i < kPaletteSize; ++i) {
+        cv::Vec3b color = i < static_cast<int>(palette.size()) ? palette[i] : cv::Vec3b(0, 0, 0);
+        out.push_back(color[2]);
+        out.push_back(color[1]);
+        out.push_back(color[0]);
+    }
+}
+
+cv::Mat toBgr(const cv::Mat& frame, cv::Size size) {
+    cv::Mat bgr = frame;
+    if (bgr.channels() == 1) {
+        cv::cvtColor(frame, bgr, cv::COLOR_GRAY2BGR);
+    }
+    if (bgr.size() != size) {
+        cv::resize(bgr, bgr, size, 0, 0, cv::INTER_AREA);
+    }
+    return bgr;
+}
+
+// Delays in centiseconds, rounded cumulatively so the clip does not drift from the source rate
+int frameDelay(int index, double fps) {
+    return static_cast<int>(std::lround((index + 1) * 100.0 / fps) - std::lround(index * 100.0 / fps));
+}
+
+bool exportGif(const std::string& path, int frameCount, const AnimationFrameFn& frameAt, double fps,
+               const AnimationOptions& options, cv::Size size) {
+    std::vector<cv::Vec3b> globalPalette;
+    std::vector<uint8_t> globalLut;
+    if (options.palette == PaletteMode::GLOBAL) {
+        ColorHistogram histogram;
+        std::mutex merge;
+        cv::parallel_for_(cv::Range(0, frameCount), [&](const cv::Range& range) {
+            ColorHistogram local;
+            for (int i = range.start; i < range.end; ++i) {
+                cv::Mat frame = frameAt(i);
+                if (!frame.empty()) {
+                    local.add(toBgr(frame, size));
+                }
+            }
+            std::lock_guard<std::mutex> lock(merge);
+            histogram.merge(local);
+        }, cv::getNumThreads());
+        globalPalette = medianCut(histogram);
+        globalLut = buildInverseMap(globalPalette);
+    }
+
+    std::vector<uint8_t> header;
+    header.insert(header.end(), {'G', 'I', 'F', '8', '9', 'a'});
+    put16(header, size.width);
+    put16(header, size.height);
+    bool hasGlobal = !globalPalette.empty();
+    header.push_back(hasGlobal ? 0xF7 : 0x70);
+    header.push_back(0);
+    header.push_back(0);
+    if (hasGlobal) {
+        putColorTable(header, globalPalette);
+    }
+    // NETSCAPE2.0 application extension: loop forever
+    header.insert(header.end(), {0x21, 0xFF, 0x0B, 'N', 'E', 'T', 'S', 'C', 'A', 'P', 'E', '2', '.', '0', 0x03, 0x01});
+    put16(header, 0);
+    header.push_back(0);
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Failed to open " << path << std::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(header.data()), header.size());
+
+    // Batches keep a bounded number of decoded frames alive; the encoded frames are written in order
+    int batch = std::max(4, cv::getNumThreads() * 2);
+    std::vector<std::vector<uint8_t>> encoded(batch);
+    for (int first = 0; first < frameCount; first += batch) {
+        int last = std::min(frameCount, first + batch);
+        cv::parallel_for_(cv::Range(first, last), [&](const cv::Range& range) {
+            cv::Mat indices;
+            for (int i = range.start; i < range.end; ++i) {
+                std::vector<uint8_t>& out = encoded[i - first];
+                out.clear();
+                cv::Mat frame = frameAt(i);
+                if (frame.empty()) {
+                    continue;
+                }
+                frame = toBgr(frame, size);
+
+                std::vector<cv::Vec3b> localPalette;
+                std::vector<uint8_t> localLut;
+                if (!hasGlobal) {
+                    ColorHistogram histogram;
+                    histogram.add(frame);
+                    localPalette = medianCut(histogram);
+                    localLut = buildInverseMap(localPalette);
+                }
+                const auto& palette = hasGlobal ? globalPalette : localPalette;
+                quantize(frame, palette, hasGlobal ? globalLut : localLut, options.dither, indices);
+
+                // Graphic control extension: keep the frame in place, per-frame delay
+                out.insert(out.end(), {0x21, 0xF9, 0x04, 0x04});
+                put16(out, frameDelay(i, fps));
+                out.push_back(0);
+                out.push_back(0);
+
+                out.push_back(0x2C);
+                put16(out, 0);
+                put16(out, 0);
+                put16(out, size.width);
+                put16(out, size.height);
+                out.push_back(hasGlobal ? 0x00 : 0x87);
+                if (!hasGlobal) {
+                    putColorTable(out, localPalette);
+                }
+                lzwEncode(indices, out);
+            }
+        });
+        for (int i = first; i < last; ++i) {
+            const std::vector<uint8_t>& out = encoded[i - first];
+            file.write(reinterpret_cast<const char*>(out.data()), out.size());
+        }
+    }
+    file.put(0x3B);
+    return static_cast<bool>(file);
+}
+
+bool exportWebp(const std::string& path, int frameCount, const AnimationFrameFn& frameAt, double fps,
+                const AnimationOptions& options, cv::Size size) {
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 11)
+    cv::Animation animation;
+    animation.frames.resize(frameCount);
+    cv::parallel_for_(cv::Range(0, frameCount), [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; ++i) {
+            cv::Mat frame = frameAt(i);
+            if (!frame.empty()) {
+                animation.frames[i] = toBgr(frame, size);
+            }
+        }
+    });
+    animation.frames.erase(std::remove_if(animation.frames.begin(), animation.frames.end(),
+                                          [](const cv::Mat& frame) { return frame.empty(); }),
+                           animation.frames.end());
+    for (int i = 0; i < static_cast<int>(animation.frames.size()); ++i) {
+        animation.durations.push_back(frameDelay(i, fps) * 10);
+    }
+    try {
+        return cv::imwriteanimation(path, animation, {cv::IMWRITE_WEBP_QUALITY, options.webpQuality});
+    } catch (const cv::Exception& e) {
+        std::cerr << "WebP export error: " << e.what() << std::endl;
+        return false;
+    }
+#else
+    (void)path; (void)frameCount; (void)frameAt; (void)fps; (void)options; (void)size;
+    std::cerr << "Animated WebP needs OpenCV 4.11 or newer (built with " << CV_VERSION << ")" << std::endl;
+    return false;
+#endif
+}
+}
+
+bool parsePaletteMode(const std::string& text, PaletteMode& mode) {
+    if (text == "global") {
+        mode = PaletteMode::GLOBAL;
+    } else if (text == "frame") {
+        mode = PaletteMode::PER_FRAME;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool exportAnimation(const std::string& path, int frameCount, const AnimationFrameFn& frameAt, double fps,
+                     const AnimationOptions& options) {
+    if (frameCount <= 0) {
+        return false;
+    }
+    cv::Mat first = frameAt(0);
+    if (first.empty()) {
+        return false;
+    }
+    fps = fps > 1.0 ? fps : 30.0;
+
+    int64 start = cv::getTickCount();
+    bool ok = options.format == AnimationFormat::WEBP
+                  ? exportWebp(path, frameCount, frameAt, fps, options, first.size())
+                  : exportGif(path, frameCount, frameAt, fps, options, first.size());
+    double ms = (cv::getTickCount() - start) * 1000.0 / cv::getTickFrequency();
+    if (ok) {
+        double clipMs = frameCount * 1000.0 / fps;
+        std::cout << "Animation saved: " << path << " (" << frameCount << " frames in " << ms << " ms, "
+                  << ms / clipMs << "x real time)" << std::endl;
+    } else {
+        std::cerr << "Failed to export " << path << std::endl;
+    }
+    return ok;
+}
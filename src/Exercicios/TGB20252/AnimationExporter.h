@@ -0,0 +1,36 @@
+#ifndef ANIMATION_EXPORTER_H
+#define ANIMATION_EXPORTER_H
+
+#include <opencv2/opencv.hpp>
+#include <functional>
+#include <string>
+
+enum class AnimationFormat {
+    GIF,
+    WEBP
+};
+
+enum class PaletteMode {
+    GLOBAL,     // one palette from every frame: smaller file, no colour flicker between frames
+    PER_FRAME   // a local colour table per frame: better colours when the clip changes a lot
+};
+
+struct AnimationOptions {
+    AnimationFormat format{AnimationFormat::GIF};
+    PaletteMode palette{PaletteMode::GLOBAL};
+    bool dither{true};
+    int webpQuality{80};
+};
+
+bool parsePaletteMode(const std::string& text, PaletteMode& mode);
+
+// Returns frame i as BGR; called from several threads at once, so it must not share state
+using AnimationFrameFn = std::function<cv::Mat(int)>;
+
+// Writes frameCount frames as a looping animation. GIF frames are median-cut quantized, dithered
+// and LZW-compressed in parallel, a batch at a time, so only a few decoded frames are alive at once.
+// Animated WebP goes through cv::imwriteanimation and needs OpenCV 4.11 or newer.
+bool exportAnimation(const std::string& path, int frameCount, const AnimationFrameFn& frameAt, double fps,
+                     const AnimationOptions& options);
+
+#endif
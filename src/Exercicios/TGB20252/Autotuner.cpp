@@ -0,0 +1,243 @@
+#include "Autotuner.h"
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <utility>
+
+namespace {
+const int kTimedRuns = 5;
+
+// Filters whose hot loops go through PixelKernels, so the ISA is worth tuning per filter
+bool usesPixelKernels(FilterType filter) {
+    return filter == FilterType::RGB_CHANNELS || filter == FilterType::VHS || filter == FilterType::TEMPORAL_DENOISE;
+}
+
+bool filterFromName(const std::string& name, FilterType& filter) {
+    for (const auto& info : kFilterRegistry) {
+        if (name == info.name) {
+            filter = info.type;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<int> threadCandidates() {
+    int cpus = std::max(1, cv::getNumberOfCPUs());
+    std::vector<int> counts{1};
+    if (cpus / 2 > 1) {
+        counts.push_back(cpus / 2);
+    }
+    if (cpus > 1) {
+        counts.push_back(cpus);
+    }
+    return counts;
+}
+}
+
+Autotuner::Autotuner(FilterManager& filters, const TiledExecutor& executor, std::string cachePath)
+    : filterManager(filters), tiledExecutor(executor), cachePath(std::move(cachePath)) {}
+
+Autotuner::~Autotuner() {
+    stop();
+}
+
+int Autotuner::load() {
+    entries.clear();
+    try {
+        cv::FileStorage fs(cachePath, cv::FileStorage::READ);
+        if (!fs.isOpened()) {
+            return 0;
+        }
+
+        // Timings from another machine or OpenCV build say nothing about this one
+        if ((int)fs["cpus"] != cv::getNumberOfCPUs() || (std::string)fs["isa"] != cpuIsaName(detectCpuIsa()) ||
+            (std::string)fs["opencv"] != CV_VERSION) {
+            std::cout << "Autotune cache " << cachePath << " is from a different machine, ignoring it" << std::endl;
+            return 0;
+        }
+
+        cv::FileNode plans = fs["plans"];
+        for (cv::FileNodeIterator it = plans.begin(); it != plans.end(); ++it) {
+            cv::FileNode node = *it;
+            FilterType filter;
+            CpuIsa isa;
+            if (!filterFromName((std::string)node["filter"], filter) ||
+                !parseCpuIsa(((std::string)node["isa"]).c_str(), isa) || !isCpuIsaAvailable(isa)) {
+                continue;
+            }
+            ExecutionPlan plan;
+            plan.tiled = (int)node["tiled"] != 0;
+            plan.threads = (int)node["threads"];
+            plan.isa = isa;
+            plan.milliseconds = (double)node["ms"];
+            plan.tuned = true;
+            store(filter, cv::Size((int)node["width"], (int)node["height"]), plan);
+        }
+    } catch (const cv::Exception& e) {
+        std::cerr << "Failed to read autotune cache " << cachePath << ": " << e.what() << std::endl;
+        entries.clear();
+    }
+    return static_cast<int>(entries.size());
+}
+
+bool Autotuner::save() const {
+    try {
+        cv::FileStorage fs(cachePath, cv::FileStorage::WRITE);
+        if (!fs.isOpened()) {
+            return false;
+        }
+        fs << "cpus" << cv::getNumberOfCPUs();
+        fs << "isa" << cpuIsaName(detectCpuIsa());
+        fs << "opencv" << CV_VERSION;
+        fs << "plans" << "[";
+        for (const auto& entry : entries) {
+            fs << "{" << "filter" << filterInfo(entry.filter).name
+               << "width" << entry.size.width << "height" << entry.size.height
+               << "tiled" << (entry.plan.tiled ? 1 : 0) << "threads" << entry.plan.threads
+               << "isa" << cpuIsaName(entry.plan.isa) << "ms" << entry.plan.milliseconds << "}";
+        }
+        fs << "]";
+        return true;
+    } catch (const cv::Exception& e) {
+        std::cerr << "Failed to write autotune cache " << cachePath << ": " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool Autotuner::isTuned(cv::Size size) const {
+    for (const auto& info : kFilterRegistry) {
+        bool found = std::any_of(entries.begin(), entries.end(), [&](const Entry& entry) {
+            return entry.filter == info.type && entry.size == size;
+        });
+        if (!found) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Autotuner::tune(const cv::Mat& frame) {
+    if (frame.empty()) {
+        return;
+    }
+
+    std::cout << "Autotuning filters at " << frame.cols << "x" << frame.rows << "..." << std::endl;
+    int previousThreads = cv::getNumThreads();
+    CpuIsa previousIsa = activeCpuIsa();
+    FilterParams params = filterManager.snapshot();
+    for (const auto& info : kFilterRegistry) {
+        ExecutionPlan plan = tuneFilter(info.type, frame, params);
+        if (cancelled.load()) {
+            break;
+        }
+        store(info.type, frame.size(), plan);
+        std::cout << "  " << info.name << ": " << (plan.tiled ? "tiled" : "whole frame") << ", "
+                  << plan.threads << " thread(s), " << cpuIsaName(plan.isa) << " - " << plan.milliseconds << " ms" << std::endl;
+    }
+    cv::setNumThreads(previousThreads);
+    forceCpuIsa(previousIsa);
+    if (cancelled.load()) {
+        return;
+    }
+
+    if (save()) {
+        std::cout << "Autotune results saved to " << cachePath << std::endl;
+    }
+}
+
+void Autotuner::start(const cv::Mat& frame) {
+    stop();
+    cancelled.store(false);
+    running.store(true);
+    worker = std::thread([this, frame] {
+        tune(frame);
+        running.store(false);
+    });
+}
+
+bool Autotuner::isRunning() const {
+    return running.load();
+}
+
+void Autotuner::stop() {
+    cancelled.store(true);
+    if (worker.joinable()) {
+        worker.join();
+    }
+    running.store(false);
+}
+
+ExecutionPlan Autotuner::tuneFilter(FilterType filter, const cv::Mat& frame, const FilterParams& params) const {
+    std::vector<CpuIsa> isas{activeCpuIsa()};
+    if (usesPixelKernels(filter)) {
+        isas.clear();
+        for (CpuIsa isa : {CpuIsa::SCALAR, CpuIsa::SSE2, CpuIsa::AVX2, CpuIsa::AVX512}) {
+            if (isCpuIsaAvailable(isa)) {
+                isas.push_back(isa);
+            }
+        }
+    }
+    std::vector<bool> layouts{false};
+    if (TiledExecutor::canTile(filter)) {
+        layouts.push_back(true);
+    }
+
+    ExecutionPlan best;
+    best.milliseconds = std::numeric_limits<double>::max();
+    for (CpuIsa isa : isas) {
+        forceCpuIsa(isa);
+        for (int threads : threadCandidates()) {
+            cv::setNumThreads(threads);
+            for (bool tiled : layouts) {
+                if (cancelled.load()) {
+                    break;
+                }
+                double ms = timeCandidate(filter, frame, params, tiled);
+                if (ms < best.milliseconds) {
+                    best.tiled = tiled;
+                    best.threads = threads;
+                    best.isa = isa;
+                    best.milliseconds = ms;
+                }
+            }
+        }
+    }
+    best.tuned = true;
+    return best;
+}
+
+double Autotuner::timeCandidate(FilterType filter, const cv::Mat& frame, const FilterParams& params, bool tiled) const {
+    ChainSpec spec;
+    spec.filter = filter;
+    spec.params = params;
+
+    std::vector<double> samples;
+    for (int i = 0; i <= kTimedRuns; ++i) {
+        int64 start = cv::getTickCount();
+        if (tiled) {
+            tiledExecutor.run(frame, spec);
+        } else {
+            filterManager.applyFilter(frame, filter, params);
+        }
+        double ms = (cv::getTickCount() - start) * 1000.0 / cv::getTickFrequency();
+        // The first run only warms caches and lazily built tables
+        if (i > 0) {
+            samples.push_back(ms);
+        }
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+void Autotuner::store(FilterType filter, cv::Size size, const ExecutionPlan& plan) {
+    auto it = std::find_if(entries.begin(), entries.end(), [&](const Entry& entry) {
+        return entry.filter == filter && entry.size == size;
+    });
+    if (it != entries.end()) {
+        it->plan = plan;
+    } else {
+        entries.push_back({filter, size, plan});
+    }
+    filterManager.setExecutionPlan(filter, size, plan);
+}
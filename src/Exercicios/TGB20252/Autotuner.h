@@ -0,0 +1,54 @@
+#ifndef AUTOTUNER_H
+#define AUTOTUNER_H
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "FilterManager.h"
+#include "TiledExecutor.h"
+
+// Times every implementation candidate of each filter (whole frame vs tiled, thread count and, for
+// filters built on the pixel kernels, the ISA) and stores the winners in FilterManager. Results are
+// cached per machine in a YAML file so only the first run at a given resolution pays for tuning.
+class Autotuner {
+public:
+    Autotuner(FilterManager& filters, const TiledExecutor& executor, std::string cachePath);
+    ~Autotuner();
+
+    // Loads cached plans for this machine into FilterManager; returns how many were applied
+    int load();
+    bool save() const;
+
+    bool isTuned(cv::Size size) const;
+    void tune(const cv::Mat& frame);
+    // tune() on a worker thread, so the first frame is not held up by a cold cache. The tuner
+    // switches the process-wide thread count and ISA, so the caller must not filter until
+    // isRunning() turns false; by then both are back to what they were before start()
+    void start(const cv::Mat& frame);
+    bool isRunning() const;
+    void stop();
+
+private:
+    struct Entry {
+        FilterType filter;
+        cv::Size size;
+        ExecutionPlan plan;
+    };
+
+    FilterManager& filterManager;
+    const TiledExecutor& tiledExecutor;
+    std::string cachePath;
+    std::vector<Entry> entries;
+    std::thread worker;
+    std::atomic<bool> running{false};
+    std::atomic<bool> cancelled{false};
+
+    ExecutionPlan tuneFilter(FilterType filter, const cv::Mat& frame, const FilterParams& params) const;
+    double timeCandidate(FilterType filter, const cv::Mat& frame, const FilterParams& params, bool tiled) const;
+    void store(FilterType filter, cv::Size size, const ExecutionPlan& plan);
+};
+
+#endif
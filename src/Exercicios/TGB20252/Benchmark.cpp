@@ -0,0 +1,300 @@
+#include "Benchmark.h"
+#include "FilterManager.h"
+#include "FrameOrienter.h"
+#include "FrameSource.h"
+#include "OverlayManager.h"
+#include "PixelKernels.h"
+#include "VideoHandler.h"
+#include <algorithm>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace {
+const IntermediatePrecision kPrecisions[] = {
+    IntermediatePrecision::FLOAT32,
+    IntermediatePrecision::FLOAT16,
+    IntermediatePrecision::FIXED16
+};
+
+struct StageTiming {
+    double milliseconds;
+    cv::Mat output;
+};
+
+StageTiming timeStage(const std::function<cv::Mat()>& stage, int iterations) {
+    std::vector<double> samples;
+    cv::Mat output;
+    for (int i = 0; i < iterations; ++i) {
+        cv::theRNG() = cv::RNG(0x5EED);
+        int64 start = cv::getTickCount();
+        output = stage();
+        samples.push_back((cv::getTickCount() - start) * 1000.0 / cv::getTickFrequency());
+    }
+    std::sort(samples.begin(), samples.end());
+    return {samples[samples.size() / 2], output};
+}
+
+void printRow(const std::string& stage, IntermediatePrecision precision, const StageTiming& timing,
+              const cv::Mat& reference, double bytesPerPixel) {
+    cv::Mat diff;
+    cv::absdiff(timing.output, reference, diff);
+    double maxError = 0.0;
+    cv::minMaxLoc(diff.reshape(1), nullptr, &maxError);
+    cv::Scalar meanPerChannel = cv::mean(diff);
+    double meanError = (meanPerChannel[0] + meanPerChannel[1] + meanPerChannel[2]) / 3.0;
+
+    std::cout << std::left << std::setw(28) << stage << std::setw(9) << precisionName(precision)
+              << std::right << std::fixed << std::setprecision(2) << std::setw(9) << timing.milliseconds
+              << std::setw(10) << maxError << std::setw(10) << std::setprecision(4) << meanError;
+    if (bytesPerPixel > 0.0) {
+        double gigabytes = bytesPerPixel * reference.total() / 1e9;
+        std::cout << std::setw(8) << std::setprecision(1) << bytesPerPixel
+                  << std::setw(9) << std::setprecision(2) << gigabytes / (timing.milliseconds / 1000.0);
+    } else {
+        std::cout << std::setw(8) << "-" << std::setw(9) << "-";
+    }
+    std::cout << std::endl;
+}
+
+void printIsaRow(const std::string& stage, CpuIsa isa, const StageTiming& timing, const StageTiming& scalar) {
+    double maxError = cv::norm(timing.output, scalar.output, cv::NORM_INF);
+    std::cout << std::left << std::setw(28) << stage << std::setw(9) << cpuIsaName(isa)
+              << std::right << std::fixed << std::setprecision(3) << std::setw(9) << timing.milliseconds
+              << std::setw(10) << std::setprecision(4) << maxError
+              << std::setw(9) << std::setprecision(2) << scalar.milliseconds / timing.milliseconds << "x" << std::endl;
+}
+}
+
+cv::Mat loadBenchmarkFrame(const std::string& imagePath, int width, int height) {
+    cv::Mat frame;
+    if (!imagePath.empty()) {
+        frame = cv::imread(imagePath, cv::IMREAD_COLOR);
+    }
+    if (frame.empty()) {
+        VideoHandler video;
+        if (video.loadVideo("../assets/videos/camera_video.mp4")) {
+            frame = video.getCurrentFrame();
+        }
+    }
+    if (frame.empty()) {
+        frame = cv::Mat(height, width, CV_8UC3);
+        for (int y = 0; y < height; ++y) {
+            cv::Vec3b* row = frame.ptr<cv::Vec3b>(y);
+            for (int x = 0; x < width; ++x) {
+                row[x] = cv::Vec3b(static_cast<uchar>(x * 255 / width), static_cast<uchar>(y * 255 / height),
+                                   static_cast<uchar>((x ^ y) & 0xFF));
+            }
+        }
+        cv::circle(frame, cv::Point(width / 2, height / 3), width / 4, cv::Scalar(40, 160, 220), -1);
+    }
+    if (frame.cols != width || frame.rows != height) {
+        cv::resize(frame, frame, cv::Size(width, height));
+    }
+    return frame;
+}
+
+int runPrecisionReport(const std::string& imagePath, int width, int height) {
+    const int iterations = 15;
+    cv::Mat frame = loadBenchmarkFrame(imagePath, width, height);
+
+    OverlayManager overlayManager;
+    overlayManager.load(width, height);
+
+    std::cout << "=== Intermediate precision report (" << width << "x" << height << ", median of "
+              << iterations << " runs) ===" << std::endl;
+    std::cout << std::left << std::setw(28) << "stage" << std::setw(9) << "mode" << std::right
+              << std::setw(9) << "ms" << std::setw(10) << "max err" << std::setw(10) << "mean err"
+              << std::setw(8) << "B/px" << std::setw(9) << "GB/s" << std::endl;
+
+    cv::Mat reference;
+    for (const auto& option : overlayManager.options()) {
+        for (IntermediatePrecision precision : kPrecisions) {
+            overlayManager.setPrecision(precision);
+            StageTiming timing = timeStage([&] { return overlayManager.apply(frame, option.type); }, iterations);
+            if (precision == IntermediatePrecision::FLOAT32) {
+                reference = timing.output;
+            }
+            // 8-bit base in and result out, plus the cached color and alpha planes at working precision
+            double bytesPerPixel = 3.0 + 3.0 + 4.0 * precisionBytes(precision);
+            printRow(option.label, precision, timing, reference, bytesPerPixel);
+        }
+    }
+
+    return 0;
+}
+
+int runIsaReport(const std::string& imagePath, int width, int height) {
+    const int iterations = 15;
+    cv::Mat frame = loadBenchmarkFrame(imagePath, width, height);
+
+    // Frame-sized sticker layer with a soft alpha ramp so every blend weight is exercised
+    cv::Mat layer;
+    cv::cvtColor(frame, layer, cv::COLOR_BGR2BGRA);
+    cv::flip(layer, layer, 1);
+    for (int y = 0; y < height; ++y) {
+        cv::Vec4b* row = layer.ptr<cv::Vec4b>(y);
+        for (int x = 0; x < width; ++x) {
+            row[x][3] = static_cast<uchar>((x + y) & 0xFF);
+        }
+    }
+
+    FilterManager filterManager;
+    filterManager.setRGBChannels(true, false, true);
+    FilterParams params = filterManager.snapshot();
+    // History with some pixels inside the denoise threshold and some outside
+    FilterParams temporalParams = params;
+    cv::Mat mirrored;
+    cv::flip(frame, mirrored, 1);
+    temporalParams.history = {frame + cv::Scalar::all(10), mirrored, frame - cv::Scalar::all(20), frame + cv::Scalar::all(40)};
+    OverlayManager overlayManager;
+    overlayManager.load(width, height);
+    cv::Mat halfFrame = toWorkingStorage(frame, IntermediatePrecision::FLOAT16);
+
+    struct Stage {
+        std::string name;
+        std::function<cv::Mat()> run;
+    };
+    std::vector<Stage> stages = {
+        {"Sticker blend", [&] {
+            cv::Mat result = frame.clone();
+            const PixelKernels& kernels = pixelKernels();
+            for (int y = 0; y < height; ++y) {
+                kernels.blendBgraOverBgr(result.ptr<uchar>(y), layer.ptr<uchar>(y), width, 0.8f);
+            }
+            return result;
+        }},
+        {"VHS aberration map", [&] {
+            // The four maps stacked as planes of one matrix: rows [0, h) red X, [h, 2h) red Y, ...
+            cv::Mat maps(height * 4, width, CV_32FC1);
+            const PixelKernels& kernels = pixelKernels();
+            for (int y = 0; y < height; ++y) {
+                kernels.aberrationMapRow(maps.ptr<float>(y), maps.ptr<float>(height + y), maps.ptr<float>(2 * height + y),
+                                         maps.ptr<float>(3 * height + y), y, width, height, 4.0f);
+            }
+            return maps;
+        }},
+        {"Channel mask (RGB toggles)", [&] { return filterManager.applyFilter(frame, FilterType::RGB_CHANNELS, params); }},
+        {"Temporal denoise", [&] { return filterManager.applyFilter(frame, FilterType::TEMPORAL_DENOISE, temporalParams); }},
+        {"fp16 row unpack", [&] {
+            cv::Mat unpacked(halfFrame.size(), CV_32FC3);
+            for (int y = 0; y < height; ++y) {
+                loadRow(halfFrame, y, unpacked.ptr<float>(y));
+            }
+            return unpacked;
+        }}
+    };
+    for (const auto& option : overlayManager.options()) {
+        OverlayType type = option.type;
+        stages.push_back({option.label, [&overlayManager, &frame, type] { return overlayManager.apply(frame, type); }});
+    }
+
+    CpuIsa previous = activeCpuIsa();
+    std::cout << "=== Pixel kernel ISA report (" << width << "x" << height << ", median of " << iterations
+              << " runs, detected " << cpuIsaName(detectCpuIsa()) << ") ===" << std::endl;
+    std::cout << std::left << std::setw(28) << "stage" << std::setw(9) << "isa" << std::right << std::setw(9) << "ms"
+              << std::setw(10) << "max diff" << std::setw(10) << "speedup" << std::endl;
+
+    const CpuIsa isas[] = {CpuIsa::SCALAR, CpuIsa::SSE2, CpuIsa::AVX2, CpuIsa::AVX512};
+    for (const auto& stage : stages) {
+        forceCpuIsa(CpuIsa::SCALAR);
+        StageTiming scalar = timeStage(stage.run, iterations);
+        for (CpuIsa isa : isas) {
+            if (!forceCpuIsa(isa)) {
+                continue;
+            }
+            printIsaRow(stage.name, isa, isa == CpuIsa::SCALAR ? scalar : timeStage(stage.run, iterations), scalar);
+        }
+    }
+
+    forceCpuIsa(previous);
+    return 0;
+}
+
+int runSourceReport(const std::string& spec, int frames, int width, int height) {
+    std::unique_ptr<FrameSource> source = openFrameSource(spec);
+    if (!source) {
+        return -1;
+    }
+
+    FilterManager filterManager;
+    FilterParams params = filterManager.snapshot();
+    std::vector<double> readTimes;
+    std::vector<double> convertTimes;
+    std::vector<double> planarTimes;
+    std::vector<double> resizeTimes;
+    std::vector<double> orientTimes;
+    std::vector<double> filterTimes;
+    FrameOrienter orienter(Orientation::CCW90, cv::Size(width, height));
+    PixelLayout layout = source->layout();
+    cv::Mat frame;
+    cv::Mat bgr;
+    cv::Mat planar;
+    cv::Mat rotated;
+    cv::Mat output;
+    cv::Mat fused;
+    cv::Size sourceSize;
+    double maxDiff = 0.0;
+
+    for (int i = 0; i < frames; ++i) {
+        int64 start = cv::getTickCount();
+        if (!source->read(frame) || frame.empty()) {
+            std::cerr << "Source ended after " << i << " frames" << std::endl;
+            break;
+        }
+        int64 read = cv::getTickCount();
+        // Planar frames: what the CPU path pays to convert, against warping the planes for the GPU
+        convertToBgr(frame, layout, bgr);
+        int64 converted = cv::getTickCount();
+        if (layout != PixelLayout::BGR) {
+            orienter.applyPlanar(frame, layout, planar);
+        }
+        int64 warped = cv::getTickCount();
+        cv::rotate(bgr, rotated, cv::ROTATE_90_COUNTERCLOCKWISE);
+        cv::resize(rotated, output, cv::Size(width, height));
+        int64 resized = cv::getTickCount();
+        orienter.apply(bgr, fused);
+        int64 oriented = cv::getTickCount();
+        filterManager.applyFilter(fused, FilterType::VHS, params);
+        int64 filtered = cv::getTickCount();
+
+        double scale = 1000.0 / cv::getTickFrequency();
+        readTimes.push_back((read - start) * scale);
+        convertTimes.push_back((converted - read) * scale);
+        planarTimes.push_back((warped - converted) * scale);
+        resizeTimes.push_back((resized - warped) * scale);
+        orientTimes.push_back((oriented - resized) * scale);
+        filterTimes.push_back((filtered - oriented) * scale);
+        sourceSize = bgr.size();
+        maxDiff = std::max(maxDiff, cv::norm(output, fused, cv::NORM_INF));
+    }
+    if (readTimes.empty()) {
+        return -1;
+    }
+
+    std::cout << "=== Frame source report: " << source->name() << " (" << sourceSize.width << "x" << sourceSize.height
+              << " at " << source->fps() << " fps, " << readTimes.size() << " frames) ===" << std::endl;
+    std::cout << std::left << std::setw(28) << "stage" << std::right << std::setw(9) << "mean" << std::setw(9) << "p50"
+              << std::setw(9) << "p95" << std::setw(9) << "max" << std::endl;
+    auto printStage = [](const std::string& stage, std::vector<double> samples) {
+        double total = 0.0;
+        for (double sample : samples) {
+            total += sample;
+        }
+        std::sort(samples.begin(), samples.end());
+        std::cout << std::left << std::setw(28) << stage << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(9) << total / samples.size() << std::setw(9) << samples[samples.size() / 2]
+                  << std::setw(9) << samples[samples.size() * 95 / 100] << std::setw(9) << samples.back() << std::endl;
+    };
+    printStage("read (decode / I/O)", readTimes);
+    if (layout != PixelLayout::BGR) {
+        printStage("YUV to BGR (CPU)", convertTimes);
+        printStage("planar orient (remap)", planarTimes);
+    }
+    printStage("rotate + resize", resizeTimes);
+    printStage("fused orient (remap)", orientTimes);
+    printStage("filter (VHS)", filterTimes);
+    std::cout << "fused vs two-pass max diff: " << std::setprecision(0) << maxDiff << std::endl;
+    return 0;
+}
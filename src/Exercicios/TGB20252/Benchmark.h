@@ -0,0 +1,22 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <opencv2/opencv.hpp>
+#include <string>
+
+// Loads the frame used by headless benchmarks: an image path, the default video or a synthetic pattern
+cv::Mat loadBenchmarkFrame(const std::string& imagePath, int width, int height);
+
+// Runs every float-based stage at each IntermediatePrecision and prints timing, bandwidth
+// and the error of the 8-bit output against the FP32 reference
+int runPrecisionReport(const std::string& imagePath, int width, int height);
+
+// Times the hand-written pixel kernels under every ISA this machine supports and checks
+// that each variant matches the scalar build
+int runIsaReport(const std::string& imagePath, int width, int height);
+
+// Reads frames from a FrameSource spec and times acquisition (decode or I/O), the rotate and
+// resize to the display size, and one filter pass as separate stages
+int runSourceReport(const std::string& spec, int frames, int width, int height);
+
+#endif
@@ -0,0 +1,150 @@
+#include "CaptureEncoder.h"
+#include "OptionParsing.h"
+#include <algorithm>
+#include <iostream>
+
+bool parseEncodeOptions(const std::string& text, EncodeOptions& options) {
+    std::string name = text.substr(0, text.find(':'));
+    std::string value = text.find(':') == std::string::npos ? "" : text.substr(text.find(':') + 1);
+
+    if (name == "png") {
+        options.format = CaptureFormat::PNG;
+        if (!value.empty() && !parseNumberOption(value, 0, 9, options.pngLevel)) {
+            return false;
+        }
+    } else if (name == "jpeg" || name == "jpg") {
+        options.format = CaptureFormat::JPEG;
+        if (!value.empty() && !parseNumberOption(value, 0, 100, options.jpegQuality)) {
+            return false;
+        }
+    } else if (name == "webp") {
+        options.format = CaptureFormat::WEBP;
+        if (value == "lossless") {
+            options.webpQuality = 101;
+        } else if (!value.empty() && !parseNumberOption(value, 1, 100, options.webpQuality)) {
+            return false;
+        }
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* captureExtension(CaptureFormat format) {
+    switch (format) {
+        case CaptureFormat::JPEG: return ".jpg";
+        case CaptureFormat::WEBP: return ".webp";
+        default: return ".png";
+    }
+}
+
+CaptureEncoder::CaptureEncoder(int workers, int maxQueued)
+    : workerCount(workers > 0 ? workers : std::max(1, std::min(4, static_cast<int>(std::thread::hardware_concurrency()) / 2))),
+      maxQueued(std::max(1, maxQueued)) {}
+
+CaptureEncoder::~CaptureEncoder() {
+    stop();
+}
+
+void CaptureEncoder::setOptions(const EncodeOptions& value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    options = value;
+}
+
+EncodeOptions CaptureEncoder::getOptions() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return options;
+}
+
+std::vector<int> CaptureEncoder::writeParams() const {
+    switch (options.format) {
+        case CaptureFormat::JPEG:
+            return {cv::IMWRITE_JPEG_QUALITY, options.jpegQuality};
+        case CaptureFormat::WEBP:
+            return {cv::IMWRITE_WEBP_QUALITY, options.webpQuality};
+        default:
+            return {cv::IMWRITE_PNG_COMPRESSION, options.pngLevel};
+    }
+}
+
+bool CaptureEncoder::submit(const cv::Mat& frame, const std::string& basePath, bool droppable) {
+    if (frame.empty()) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (droppable && static_cast<int>(jobs.size()) >= maxQueued) {
+            ++droppedFrames;
+            return false;
+        }
+        jobs.push_back({frame, basePath + captureExtension(options.format), writeParams()});
+        if (!running) {
+            running = true;
+            for (int i = 0; i < workerCount; ++i) {
+                workers.emplace_back(&CaptureEncoder::workerLoop, this);
+            }
+        }
+    }
+    wake.notify_one();
+    return true;
+}
+
+int CaptureEncoder::pending() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<int>(jobs.size()) + active;
+}
+
+int CaptureEncoder::dropped() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return droppedFrames;
+}
+
+void CaptureEncoder::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers.clear();
+}
+
+void CaptureEncoder::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return !running || !jobs.empty(); });
+        if (jobs.empty()) {
+            break;
+        }
+        Job job = std::move(jobs.front());
+        jobs.pop_front();
+        ++active;
+        lock.unlock();
+
+        cv::Mat output = job.frame;
+        if (output.channels() == 1) {
+            cv::cvtColor(job.frame, output, cv::COLOR_GRAY2BGR);
+        }
+        bool written = false;
+        try {
+            written = cv::imwrite(job.path, output, job.params);
+        } catch (const cv::Exception& e) {
+            std::cerr << "Encoder error: " << e.what() << std::endl;
+        }
+        if (written) {
+            std::cout << "Photo saved: " << job.path << " (" << output.cols << "x" << output.rows << ")" << std::endl;
+        } else {
+            std::cerr << "Failed to save " << job.path << std::endl;
+        }
+
+        // Release the frame before reporting completion so its pooled buffer can be reused
+        job.frame.release();
+        output.release();
+        lock.lock();
+        --active;
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef CAPTURE_ENCODER_H
+#define CAPTURE_ENCODER_H
+
+#include <opencv2/opencv.hpp>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class CaptureFormat {
+    PNG,
+    JPEG,
+    WEBP
+};
+
+struct EncodeOptions {
+    CaptureFormat format{CaptureFormat::PNG};
+    int pngLevel{3};        // 0-9, higher is smaller and slower
+    int jpegQuality{95};    // 0-100
+    int webpQuality{101};   // 1-100 lossy, above 100 lossless
+};
+
+// Parses "png[:level]", "jpeg[:quality]" / "jpg[:quality]" or "webp[:quality|lossless]"
+bool parseEncodeOptions(const std::string& text, EncodeOptions& options);
+const char* captureExtension(CaptureFormat format);
+
+// Writes frames to disk on a small pool of worker threads. Queued frames are shared cv::Mat headers:
+// published frames are never written again and pooled buffers are only recycled once the encoder
+// drops its reference, so submitting costs no copy. The queue is bounded; when it is full the frame
+// is rejected and counted instead of stalling the caller.
+class CaptureEncoder {
+public:
+    explicit CaptureEncoder(int workers = 0, int maxQueued = 48);
+    ~CaptureEncoder();
+
+    void setOptions(const EncodeOptions& options);
+    EncodeOptions getOptions() const;
+
+    // basePath gets the extension of the current format; returns false if the frame was dropped.
+    // Single captures pass droppable = false and are queued even past the limit
+    bool submit(const cv::Mat& frame, const std::string& basePath, bool droppable = true);
+    int pending() const;
+    int dropped() const;
+    // Finishes everything queued, then joins the workers
+    void stop();
+
+private:
+    struct Job {
+        cv::Mat frame;
+        std::string path;
+        std::vector<int> params;
+    };
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<std::thread> workers;
+    std::deque<Job> jobs;
+    EncodeOptions options;
+    int workerCount;
+    int maxQueued;
+    int active{0};
+    int droppedFrames{0};
+    bool running{false};
+
+    void workerLoop();
+    std::vector<int> writeParams() const;
+};
+
+#endif
@@ -0,0 +1,103 @@
+#include "CaptureRenderer.h"
+#include <algorithm>
+#include <cmath>
+
+CaptureRenderer::CaptureRenderer(const FilterManager& filters, const StickerManager& stickers, CaptureEncoder& encoder)
+    : filterManager(filters), stickerManager(stickers), encoder(encoder) {}
+
+CaptureRenderer::~CaptureRenderer() {
+    stop();
+}
+
+void CaptureRenderer::submit(const cv::Mat& source, const EditRecipe& recipe, const std::string& basePath) {
+    if (source.empty()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back({source, recipe, basePath});
+        if (!running) {
+            running = true;
+            worker = std::thread(&CaptureRenderer::workerLoop, this);
+        }
+    }
+    wake.notify_one();
+}
+
+int CaptureRenderer::pending() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<int>(jobs.size()) + (busy ? 1 : 0);
+}
+
+// Queued captures are finished before the worker exits, so nothing the user asked for is lost
+void CaptureRenderer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    wake.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+cv::Mat CaptureRenderer::replay(const cv::Mat& source, const EditRecipe& recipe) {
+    if (recipe.previewSize.empty() || source.empty()) {
+        return source;
+    }
+    double scaleX = static_cast<double>(source.cols) / recipe.previewSize.width;
+    double scaleY = static_cast<double>(source.rows) / recipe.previewSize.height;
+    double scale = std::sqrt(scaleX * scaleY);
+
+    cv::Mat output = source;
+    if (recipe.filter != FilterType::NONE) {
+        FilterParams params = FilterManager::scaleParams(recipe.params, scale, source.size());
+        output = filterManager.applyFilter(source, recipe.filter, params);
+    }
+
+    bool needsColor = recipe.overlay != OverlayType::NONE || !recipe.stickers.empty();
+    if (needsColor && output.channels() == 1) {
+        cv::cvtColor(output, output, cv::COLOR_GRAY2BGR);
+    }
+
+    if (recipe.overlay != OverlayType::NONE) {
+        overlayManager.setPrecision(recipe.params.precision);
+        if (overlaySize != source.size()) {
+            overlayManager.load(source.cols, source.rows);
+            overlaySize = source.size();
+        }
+        output = overlayManager.apply(output, recipe.overlay);
+    }
+
+    if (!recipe.stickers.empty()) {
+        std::vector<StickerPlacement> mapped = recipe.stickers;
+        for (auto& placement : mapped) {
+            placement.position = cv::Point(static_cast<int>(std::lround(placement.position.x * scaleX)),
+                                           static_cast<int>(std::lround(placement.position.y * scaleY)));
+        }
+        if (output.data == source.data) {
+            output = source.clone();
+        }
+        stickerManager.applyPlacements(output, mapped, scale);
+    }
+    return output;
+}
+
+void CaptureRenderer::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return !running || !jobs.empty(); });
+        if (jobs.empty()) {
+            break;
+        }
+        Job job = std::move(jobs.front());
+        jobs.pop_front();
+        busy = true;
+        lock.unlock();
+
+        encoder.submit(replay(job.source, job.recipe), job.path, false);
+
+        lock.lock();
+        busy = false;
+    }
+}
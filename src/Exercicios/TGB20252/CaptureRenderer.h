@@ -0,0 +1,66 @@
+#ifndef CAPTURE_RENDERER_H
+#define CAPTURE_RENDERER_H
+
+#include <opencv2/opencv.hpp>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "FilterManager.h"
+#include "OverlayManager.h"
+#include "StickerManager.h"
+#include "CaptureEncoder.h"
+
+// Everything the user did to the preview, described independently of its resolution
+struct EditRecipe {
+    FilterType filter{FilterType::NONE};
+    FilterParams params;
+    OverlayType overlay{OverlayType::NONE};
+    std::vector<StickerPlacement> stickers;
+    cv::Size previewSize;
+};
+
+// Renders captures in the background. Edits are made on the screen-sized proxy; on capture the
+// recipe is replayed on the source-resolution frame, with neighbourhood sizes, the face mask and
+// sticker positions mapped from preview to source coordinates, and the result goes to the encoder.
+class CaptureRenderer {
+public:
+    CaptureRenderer(const FilterManager& filters, const StickerManager& stickers, CaptureEncoder& encoder);
+    ~CaptureRenderer();
+
+    // source must not be written afterwards; previewSize empty in the recipe saves source as is.
+    // basePath is completed with the encoder's extension
+    void submit(const cv::Mat& source, const EditRecipe& recipe, const std::string& basePath);
+    int pending() const;
+    void stop();
+
+    cv::Mat replay(const cv::Mat& source, const EditRecipe& recipe);
+
+private:
+    struct Job {
+        cv::Mat source;
+        EditRecipe recipe;
+        std::string path;
+    };
+
+    const FilterManager& filterManager;
+    const StickerManager& stickerManager;
+    CaptureEncoder& encoder;
+    // Overlay planes at source resolution, rebuilt only when the capture size changes (worker only)
+    OverlayManager overlayManager;
+    cv::Size overlaySize;
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::thread worker;
+    std::deque<Job> jobs;
+    bool running{false};
+    bool busy{false};
+
+    void workerLoop();
+};
+
+#endif
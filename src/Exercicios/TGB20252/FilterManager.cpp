@@ -1,116 +1,108 @@
 #include "FilterManager.h"
+#include "PixelKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
 
-FilterManager::FilterManager() : kernelSize(15), brightnessValue(50), contrastValue(1.5), enableR(true), enableG(true), enableB(true) {}
-
-std::vector<FilterInfo> FilterManager::getAvailableFilters() const {
-    return {
-        {FilterType::PORTRAIT_BLUR, "Portrait", "Simula modo retrato com fundo desfocado e rosto nitido."},
-        {FilterType::BILATERAL_FILTERING, "Bilateral Filtering", "Suaviza pele e fundo mantendo contornos definidos."},
-        {FilterType::BOX_BLUR, "Box Blur", "Desfoca uniformemente a imagem."},
-        {FilterType::MEDIAN_BLUR, "Median Blur", "Reduz ruído preservando bordas."},
-        {FilterType::SHARPEN, "Sharpen", "Destaca bordas e realca detalhes finos."},
-        {FilterType::LAPLACIAN, "Laplacian", "Realça áreas de transição rápida de intensidade."},
-        {FilterType::SOBEL, "Sobel", "Detecta bordas horizontais e verticais."},
-        {FilterType::CANNY, "Canny Edge", "Extrai bordas com alta precisão."},
-        {FilterType::GRAYSCALE, "B&W", "Converte para tons de cinza equilibrados."},
-        {FilterType::SEPIA, "Vintage", "Aplica tonalidade quente inspirada em filme antigo."},
-        {FilterType::INVERT, "Negative", "Inverte as cores para um efeito experimental."},
-        {FilterType::BRIGHTNESS, "Bright", "Eleva o brilho geral de maneira suave."},
-        {FilterType::CONTRAST, "Contrast", "Amplifica contraste e profundidade."},
-        {FilterType::EMBOSS, "Emboss", "Cria relevo simulando iluminação lateral."},
-        {FilterType::RGB_CHANNELS, "RGB", "Liga ou desliga rapidamente cada canal de cor."},
-        {FilterType::VHS, "VHS", "Simula fita analogica com bleed, scanlines e ruido."}
-    };
-}
-
-std::string FilterManager::getFilterDescription(FilterType filter) const {
-    for (const auto& info : getAvailableFilters()) {
-        if (info.type == filter) {
-            return info.description;
-        }
-    }
-    return "No description available.";
+FilterManager::FilterManager() {}
+
+const FilterList& FilterManager::getAvailableFilters() const {
+    return kFilterRegistry;
+}
+
+const char* FilterManager::getFilterDescription(FilterType filter) const {
+    return filterInfo(filter).description;
+}
+
+FilterParams FilterManager::snapshot() const {
+    std::lock_guard<std::mutex> lock(paramsMutex);
+    return params;
 }
 
 void FilterManager::setKernelSize(int size) {
-    kernelSize = (size % 2 == 0) ? size + 1 : size;
-    if (kernelSize < 3) kernelSize = 3;
+    int value = (size % 2 == 0) ? size + 1 : size;
+    if (value < 3) value = 3;
+    std::lock_guard<std::mutex> lock(paramsMutex);
+    params.kernelSize = value;
 }
 
 void FilterManager::setBrightnessValue(int value) {
-    brightnessValue = value;
+    std::lock_guard<std::mutex> lock(paramsMutex);
+    params.brightnessValue = value;
 }
 
 void FilterManager::setContrastValue(double value) {
-    contrastValue = value;
+    std::lock_guard<std::mutex> lock(paramsMutex);
+    params.contrastValue = value;
 }
 
-void FilterManager::setFaceMask(const cv::Mat& mask) {
-    faceMask = mask.clone();
+void FilterManager::setPrecision(IntermediatePrecision precision) {
+    std::lock_guard<std::mutex> lock(paramsMutex);
+    params.precision = precision;
 }
 
-cv::Mat FilterManager::applyFilter(const cv::Mat& input, FilterType filter, ChannelMode channel) {
-    if (input.empty()) return input;
-    
-    cv::Mat result;
-    
-    switch (filter) {
-        case FilterType::NONE:
-            result = input.clone();
-            break;
-        case FilterType::BILATERAL_FILTERING:
-            result = gaussianBlur(input);
-            break;
-        case FilterType::BOX_BLUR:
-            result = boxBlur(input);
-            break;
-        case FilterType::MEDIAN_BLUR:
-            result = medianBlur(input);
-            break;
-        case FilterType::PORTRAIT_BLUR:
-            result = portraitBlur(input);
-            break;
-        case FilterType::SHARPEN:
-            result = sharpen(input);
-            break;
-        case FilterType::LAPLACIAN:
-            result = laplacian(input);
-            break;
-        case FilterType::SOBEL:
-            result = sobel(input);
-            break;
-        case FilterType::CANNY:
-            result = canny(input);
-            break;
-        case FilterType::GRAYSCALE:
-            result = grayscale(input);
-            break;
-        case FilterType::SEPIA:
-            result = sepia(input);
-            break;
-        case FilterType::INVERT:
-            result = invert(input);
-            break;
-        case FilterType::BRIGHTNESS:
-            result = brightness(input);
-            break;
-        case FilterType::CONTRAST:
-            result = contrast(input);
-            break;
-        case FilterType::EMBOSS:
-            result = emboss(input);
-            break;
-        case FilterType::RGB_CHANNELS:
-            result = rgbChannels(input);
-            break;
-        case FilterType::VHS:
-            result = vhs(input);
-            break;
-        default:
-            result = input.clone();
+// The mask is shared with every snapshot taken after this call instead of being cloned;
+// callers hand over a freshly built mask and must not write into it afterwards.
+void FilterManager::setFaceMask(cv::Mat mask) {
+    std::shared_ptr<const cv::Mat> shared;
+    if (!mask.empty()) {
+        shared = std::make_shared<const cv::Mat>(std::move(mask));
     }
-    
-    return applyChannelMode(result, channel);
+    std::lock_guard<std::mutex> lock(paramsMutex);
+    params.faceMask = std::move(shared);
+}
+
+void FilterManager::setHistory(std::vector<cv::Mat> frames) {
+    std::lock_guard<std::mutex> lock(paramsMutex);
+    params.history = std::move(frames);
+}
+
+void FilterManager::setRGBChannels(bool r, bool g, bool b) {
+    std::lock_guard<std::mutex> lock(paramsMutex);
+    params.enableR = r;
+    params.enableG = g;
+    params.enableB = b;
+}
+
+void FilterManager::getRGBChannels(bool& r, bool& g, bool& b) const {
+    std::lock_guard<std::mutex> lock(paramsMutex);
+    r = params.enableR;
+    g = params.enableG;
+    b = params.enableB;
+}
+
+namespace {
+// History frame index exists and lines up with the input (a strip or region gets matching ROIs)
+bool historyMatches(const FilterParams& params, const cv::Mat& input, int index) {
+    return index < static_cast<int>(params.history.size()) && params.history[index].size() == input.size() &&
+           params.history[index].type() == input.type();
+}
+
+cv::Mat maskChannels(const cv::Mat& input, bool keepB, bool keepG, bool keepR) {
+    cv::Mat result(input.size(), CV_8UC3);
+    const PixelKernels& kernels = pixelKernels();
+    for (int y = 0; y < input.rows; ++y) {
+        kernels.maskChannels(input.ptr<uchar>(y), result.ptr<uchar>(y), input.cols, keepB, keepG, keepR);
+    }
+    return result;
+}
+}
+
+void FilterManager::setExecutionPlan(FilterType filter, cv::Size size, const ExecutionPlan& plan) {
+    std::lock_guard<std::mutex> lock(paramsMutex);
+    plans[{filter, {size.width, size.height}}] = plan;
+}
+
+ExecutionPlan FilterManager::executionPlan(FilterType filter, cv::Size size) const {
+    std::lock_guard<std::mutex> lock(paramsMutex);
+    auto it = plans.find({filter, {size.width, size.height}});
+    return it != plans.end() ? it->second : ExecutionPlan{};
+}
+
+void FilterManager::clearExecutionPlans() {
+    std::lock_guard<std::mutex> lock(paramsMutex);
+    plans.clear();
 }
 
 cv::Mat FilterManager::applyChannelMode(const cv::Mat& input, ChannelMode channel) {
@@ -124,78 +116,76 @@ cv::Mat FilterManager::applyChannelMode(const cv::Mat& input, ChannelMode channe
         return gray;
     }
     
-    std::vector<cv::Mat> channels(3);
-    cv::split(input, channels);
-    
-    cv::Mat result = input.clone();
-    
     switch (channel) {
         case ChannelMode::RED:
-            channels[1] = cv::Mat::zeros(input.size(), CV_8UC1);
-            channels[2] = cv::Mat::zeros(input.size(), CV_8UC1);
-            break;
+            return maskChannels(input, true, false, false);
         case ChannelMode::GREEN:
-            channels[0] = cv::Mat::zeros(input.size(), CV_8UC1);
-            channels[2] = cv::Mat::zeros(input.size(), CV_8UC1);
-            break;
+            return maskChannels(input, false, true, false);
         case ChannelMode::BLUE:
-            channels[0] = cv::Mat::zeros(input.size(), CV_8UC1);
-            channels[1] = cv::Mat::zeros(input.size(), CV_8UC1);
-            break;
+            return maskChannels(input, false, false, true);
         default:
-            break;
+            return input.clone();
     }
-    
-    cv::merge(channels, result);
-    return result;
 }
 
-cv::Mat FilterManager::gaussianBlur(const cv::Mat& input) {
+template <>
+cv::Mat FilterManager::kernel<FilterType::BILATERAL_FILTERING>(const cv::Mat& input, const FilterParams& params) {
     cv::Mat result;
     cv::bilateralFilter(input, result, 15, 75.0, 15.0);
     return result;
 }
 
-cv::Mat FilterManager::boxBlur(const cv::Mat& input) {
+template <>
+cv::Mat FilterManager::kernel<FilterType::BOX_BLUR>(const cv::Mat& input, const FilterParams& params) {
     cv::Mat result;
-    cv::blur(input, result, cv::Size(kernelSize, kernelSize));
+    cv::blur(input, result, cv::Size(params.kernelSize, params.kernelSize));
     return result;
 }
 
-cv::Mat FilterManager::medianBlur(const cv::Mat& input) {
+template <>
+cv::Mat FilterManager::kernel<FilterType::MEDIAN_BLUR>(const cv::Mat& input, const FilterParams& params) {
     cv::Mat result;
-    cv::medianBlur(input, result, kernelSize);
+    cv::medianBlur(input, result, params.kernelSize);
     return result;
 }
 
-cv::Mat FilterManager::portraitBlur(const cv::Mat& input) {
+template <>
+cv::Mat FilterManager::kernel<FilterType::PORTRAIT_BLUR>(const cv::Mat& input, const FilterParams& params) {
     cv::Mat blurred;
     cv::GaussianBlur(input, blurred, cv::Size(71, 71), 25.0);
     cv::GaussianBlur(blurred, blurred, cv::Size(31, 31), 12.0);
     
-    if (faceMask.empty() || faceMask.size() != input.size()) {
+    if (!params.faceMask || params.faceMask->size() != input.size()) {
         return blurred;
     }
     
-    cv::Mat mask3channel;
-    if (faceMask.channels() == 1) {
-        cv::cvtColor(faceMask, mask3channel, cv::COLOR_GRAY2BGR);
-    } else {
-        mask3channel = faceMask.clone();
+    cv::Mat faceMask = *params.faceMask;
+    if (faceMask.channels() != 1) {
+        cv::cvtColor(faceMask, faceMask, cv::COLOR_BGR2GRAY);
     }
     
-    cv::Mat maskFloat, inputFloat, blurredFloat;
-    mask3channel.convertTo(maskFloat, CV_32F, 1.0/255.0);
-    input.convertTo(inputFloat, CV_32F);
-    blurred.convertTo(blurredFloat, CV_32F);
-    
-    cv::Mat result = inputFloat.mul(maskFloat) + blurredFloat.mul(cv::Scalar(1.0, 1.0, 1.0) - maskFloat);
-    result.convertTo(result, CV_8U);
+    // Mask blend fused per pixel: reads the 8-bit planes and keeps the float math in registers
+    int channels = input.channels();
+    cv::Mat result(input.size(), input.type());
+    for (int y = 0; y < input.rows; ++y) {
+        const uchar* in = input.ptr<uchar>(y);
+        const uchar* bl = blurred.ptr<uchar>(y);
+        const uchar* m = faceMask.ptr<uchar>(y);
+        uchar* out = result.ptr<uchar>(y);
+        for (int x = 0; x < input.cols; ++x) {
+            float weight = m[x] * (1.0f / 255.0f);
+            for (int c = 0; c < channels; ++c) {
+                int i = x * channels + c;
+                out[i] = cv::saturate_cast<uchar>(in[i] * weight + bl[i] * (1.0f - weight));
+            }
+        }
+    }
     
     return result;
 }
 
-cv::Mat FilterManager::sharpen(const cv::Mat& input) {
+template <>
+cv::Mat FilterManager::kernel<FilterType::SHARPEN>(const cv::Mat& input, const FilterParams& params) {
     cv::Mat blurred;
     cv::GaussianBlur(input, blurred, cv::Size(0, 0), 3);
     cv::Mat result;
@@ -203,66 +193,39 @@ cv::Mat FilterManager::sharpen(const cv::Mat& input) {
     return result;
 }
 
-cv::Mat FilterManager::laplacian(const cv::Mat& input) {
-    cv::Mat gray, result;
-    if (input.channels() == 3) {
-        cv::cvtColor(input, gray, cv::COLOR_BGR2GRAY);
-    } else {
-        gray = input;
-    }
+template <>
+cv::Mat FilterManager::kernel<FilterType::LAPLACIAN>(const cv::Mat& gray, const FilterParams& params) {
+    cv::Mat result;
     cv::Laplacian(gray, result, CV_16S, 3);
     cv::convertScaleAbs(result, result);
-    if (input.channels() == 3) {
-        cv::cvtColor(result, result, cv::COLOR_GRAY2BGR);
-    }
     return result;
 }
 
-cv::Mat FilterManager::sobel(const cv::Mat& input) {
-    cv::Mat gray, gradX, gradY, result;
-    if (input.channels() == 3) {
-        cv::cvtColor(input, gray, cv::COLOR_BGR2GRAY);
-    } else {
-        gray = input;
-    }
+template <>
+cv::Mat FilterManager::kernel<FilterType::SOBEL>(const cv::Mat& gray, const FilterParams& params) {
+    cv::Mat gradX, gradY, result;
     cv::Sobel(gray, gradX, CV_16S, 1, 0);
     cv::Sobel(gray, gradY, CV_16S, 0, 1);
     cv::convertScaleAbs(gradX, gradX);
     cv::convertScaleAbs(gradY, gradY);
     cv::addWeighted(gradX, 0.5, gradY, 0.5, 0, result);
-    if (input.channels() == 3) {
-        cv::cvtColor(result, result, cv::COLOR_GRAY2BGR);
-    }
     return result;
 }
 
-cv::Mat FilterManager::canny(const cv::Mat& input) {
-    cv::Mat gray, result;
-    if (input.channels() == 3) {
-        cv::cvtColor(input, gray, cv::COLOR_BGR2GRAY);
-    } else {
-        gray = input;
-    }
+template <>
+cv::Mat FilterManager::kernel<FilterType::CANNY>(const cv::Mat& gray, const FilterParams& params) {
+    cv::Mat result;
     cv::Canny(gray, result, 50, 150);
-    if (input.channels() == 3) {
-        cv::cvtColor(result, result, cv::COLOR_GRAY2BGR);
-    }
     return result;
 }
 
-cv::Mat FilterManager::grayscale(const cv::Mat& input) {
-    if (input.channels() == 1) {
-        cv::Mat result;
-        cv::cvtColor(input, result, cv::COLOR_GRAY2BGR);
-        return result;
-    }
-    cv::Mat gray, result;
-    cv::cvtColor(input, gray, cv::COLOR_BGR2GRAY);
-    cv::cvtColor(gray, result, cv::COLOR_GRAY2BGR);
-    return result;
+template <>
+cv::Mat FilterManager::kernel<FilterType::GRAYSCALE>(const cv::Mat& gray, const FilterParams& params) {
+    return gray;
 }
 
-cv::Mat FilterManager::sepia(const cv::Mat& input) {
+template <>
+cv::Mat FilterManager::kernel<FilterType::SEPIA>(const cv::Mat& input, const FilterParams& params) {
     cv::Mat result = input.clone();
     cv::Mat kernel = (cv::Mat_<float>(3, 3) << 
         0.272, 0.534, 0.131,
@@ -272,25 +235,29 @@ cv::Mat FilterManager::sepia(const cv::Mat& input) {
     return result;
 }
 
-cv::Mat FilterManager::invert(const cv::Mat& input) {
+template <>
+cv::Mat FilterManager::kernel<FilterType::INVERT>(const cv::Mat& input, const FilterParams& params) {
     cv::Mat result;
     cv::bitwise_not(input, result);
     return result;
 }
 
-cv::Mat FilterManager::brightness(const cv::Mat& input) {
+template <>
+cv::Mat FilterManager::kernel<FilterType::BRIGHTNESS>(const cv::Mat& input, const FilterParams& params) {
     cv::Mat result;
-    input.convertTo(result, -1, 1, brightnessValue);
+    input.convertTo(result, -1, 1, params.brightnessValue);
     return result;
 }
 
-cv::Mat FilterManager::contrast(const cv::Mat& input) {
+template <>
+cv::Mat FilterManager::kernel<FilterType::CONTRAST>(const cv::Mat& input, const FilterParams& params) {
     cv::Mat result;
-    input.convertTo(result, -1, contrastValue, 0);
+    input.convertTo(result, -1, params.contrastValue, 0);
     return result;
 }
 
-cv::Mat FilterManager::emboss(const cv::Mat& input) {
+template <>
+cv::Mat FilterManager::kernel<FilterType::EMBOSS>(const cv::Mat& input, const FilterParams& params) {
     cv::Mat kernel = (cv::Mat_<float>(3, 3) << 
         -2, -1, 0,
         -1,  1, 1,
@@ -301,7 +268,8 @@ cv::Mat FilterManager::emboss(const cv::Mat& input) {
     return result;
 }
 
-cv::Mat FilterManager::vhs(const cv::Mat& input) {
+template <>
+cv::Mat FilterManager::kernel<FilterType::VHS>(const cv::Mat& input, const FilterParams& params) {
     cv::Mat floatInput;
     input.convertTo(floatInput, CV_32FC3, 1.0f / 255.0f);
 
@@ -347,9 +315,15 @@ cv::Mat FilterManager::vhs(const cv::Mat& input) {
     colorCh[0] = 0.85f * colorCh[0] + 0.15f * blueShift;
     cv::merge(colorCh, processed);
 
+    // Tape ghosting: the previous frame bleeds in slightly offset; a still image falls back to itself
+    const cv::Mat& previous = historyMatches(params, input, 0) ? params.history[0] : input;
+    cv::Mat previousFloat = floatInput;
+    if (previous.data != input.data) {
+        previous.convertTo(previousFloat, CV_32FC3, 1.0f / 255.0f);
+    }
     cv::Mat ghostTransform = (cv::Mat_<float>(2, 3) << 1, 0, 6, 0, 1, 0);
     cv::Mat ghost;
-    cv::warpAffine(floatInput, ghost, ghostTransform, floatInput.size(),
+    cv::warpAffine(previousFloat, ghost, ghostTransform, floatInput.size(),
                    cv::INTER_LINEAR, cv::BORDER_REFLECT);
     processed = 0.85f * processed + 0.15f * ghost;
 
@@ -361,24 +335,15 @@ cv::Mat FilterManager::vhs(const cv::Mat& input) {
     cv::split(processed, aberrationChannels);
     int rows = processed.rows;
     int cols = processed.cols;
-    float cx = cols * 0.5f;
-    float cy = rows * 0.5f;
     cv::Mat mapXRed(rows, cols, CV_32FC1);
     cv::Mat mapYRed(rows, cols, CV_32FC1);
     cv::Mat mapXBlue(rows, cols, CV_32FC1);
     cv::Mat mapYBlue(rows, cols, CV_32FC1);
     const float aberrStrength = 4.0f;
+    const PixelKernels& kernels = pixelKernels();
     for (int y = 0; y < rows; ++y) {
-        float normY = (y - cy) / rows;
-        for (int x = 0; x < cols; ++x) {
-            float normX = (x - cx) / cols;
-            float offsetX = aberrStrength * normX;
-            float offsetY = aberrStrength * normY;
-            mapXRed.at<float>(y, x) = static_cast<float>(x) + offsetX;
-            mapYRed.at<float>(y, x) = static_cast<float>(y) + offsetY;
-            mapXBlue.at<float>(y, x) = static_cast<float>(x) - offsetX;
-            mapYBlue.at<float>(y, x) = static_cast<float>(y) - offsetY;
-        }
+        kernels.aberrationMapRow(mapXRed.ptr<float>(y), mapYRed.ptr<float>(y), mapXBlue.ptr<float>(y), mapYBlue.ptr<float>(y),
+                                 y, cols, rows, aberrStrength);
     }
     cv::Mat remappedRed, remappedBlue;
     cv::remap(aberrationChannels[2], remappedRed, mapXRed, mapYRed, cv::INTER_LINEAR, cv::BORDER_REFLECT);
@@ -414,29 +379,144 @@ cv::Mat FilterManager::vhs(const cv::Mat& input) {
     return result8U;
 }
 
-void FilterManager::setRGBChannels(bool r, bool g, bool b) {
-    enableR = r;
-    enableG = g;
-    enableB = b;
+template <>
+cv::Mat FilterManager::kernel<FilterType::RGB_CHANNELS>(const cv::Mat& input, const FilterParams& params) {
+    if (input.channels() != 3) return input;
+    
+    return maskChannels(input, params.enableB, params.enableG, params.enableR);
 }
 
-void FilterManager::getRGBChannels(bool& r, bool& g, bool& b) const {
-    r = enableR;
-    g = enableG;
-    b = enableB;
+template <>
+cv::Mat FilterManager::kernel<FilterType::GHOST_TRAIL>(const cv::Mat& input, const FilterParams& params) {
+    // Exponentially fading trail: weight 1 for the current frame, then 0.6, 0.36, ... for older ones
+    const int maxFrames = filterTraits<FilterType::GHOST_TRAIL>.historyFrames;
+    std::vector<const cv::Mat*> frames{&input};
+    std::vector<int> weights{256};
+    for (int i = 0; i < maxFrames && historyMatches(params, input, i); ++i) {
+        frames.push_back(&params.history[i]);
+        weights.push_back(weights.back() * 6 / 10);
+    }
+    if (frames.size() == 1) {
+        return input.clone();
+    }
+
+    // Folded in from the oldest frame with accumulateWeighted: giving each newer frame its share of
+    // the weight seen so far leaves every frame with weight / total, accumulated in FP32
+    cv::Mat average;
+    frames.back()->convertTo(average, CV_MAKETYPE(CV_32F, input.channels()));
+    int seen = weights.back();
+    for (int f = static_cast<int>(frames.size()) - 2; f >= 0; --f) {
+        seen += weights[f];
+        cv::accumulateWeighted(*frames[f], average, static_cast<double>(weights[f]) / seen);
+    }
+    cv::Mat result;
+    average.convertTo(result, input.type());
+    return result;
 }
 
-cv::Mat FilterManager::rgbChannels(const cv::Mat& input) {
-    if (input.channels() != 3) return input;
+template <>
+cv::Mat FilterManager::kernel<FilterType::TEMPORAL_DENOISE>(const cv::Mat& input, const FilterParams& params) {
+    // Averages each pixel with the previous frames that stayed within the threshold, so moving
+    // edges keep the current value and only static noise is smoothed
+    const int maxFrames = filterTraits<FilterType::TEMPORAL_DENOISE>.historyFrames;
+    const int threshold = 24;
+    if (input.type() != CV_8UC3 || !historyMatches(params, input, 0)) {
+        return input.clone();
+    }
+
+    std::vector<const cv::Mat*> frames;
+    for (int i = 0; i < maxFrames && historyMatches(params, input, i); ++i) {
+        frames.push_back(&params.history[i]);
+    }
+
+    cv::Mat result(input.size(), CV_8UC3);
+    std::vector<const uchar*> rows(frames.size());
+    const PixelKernels& kernels = pixelKernels();
+    for (int y = 0; y < input.rows; ++y) {
+        for (size_t f = 0; f < frames.size(); ++f) {
+            rows[f] = frames[f]->ptr<uchar>(y);
+        }
+        kernels.temporalDenoiseRow(input.ptr<uchar>(y), rows.data(), static_cast<int>(rows.size()), result.ptr<uchar>(y),
+                                   input.cols, threshold);
+    }
+    return result;
+}
+
+template <>
+cv::Mat FilterManager::kernel<FilterType::NONE>(const cv::Mat& input, const FilterParams& params) {
+    return input.clone();
+}
+
+namespace {
+cv::Mat toGray(const cv::Mat& input) {
+    if (input.channels() == 1) {
+        return input.clone();
+    }
+    cv::Mat gray;
+    cv::cvtColor(input, gray, cv::COLOR_BGR2GRAY);
+    return gray;
+}
+}
+
+// Registry traits resolve at compile time, so luma filters share one hoisted gray conversion
+template <FilterType F>
+cv::Mat FilterManager::run(const cv::Mat& input, const FilterParams& params) {
+    if constexpr (filterTraits<F>.needsGray) {
+        return kernel<F>(toGray(input), params);
+    } else {
+        return kernel<F>(input, params);
+    }
+}
+
+template <std::size_t... I>
+constexpr std::array<FilterManager::Kernel, sizeof...(I)> FilterManager::makeDispatchTable(std::index_sequence<I...>) {
+    return {{&FilterManager::run<static_cast<FilterType>(I)>...}};
+}
+
+cv::Mat FilterManager::applyFilter(const cv::Mat& input, FilterType filter, ChannelMode channel) const {
+    return applyFilter(input, filter, snapshot(), channel);
+}
+
+cv::Mat FilterManager::applyFilter(const cv::Mat& input, FilterType filter, const FilterParams& params, ChannelMode channel) const {
+    if (input.empty()) return input;
     
-    std::vector<cv::Mat> channels(3);
-    cv::split(input, channels);
+    static constexpr std::array<Kernel, kFilterTypeCount> dispatch =
+        makeDispatchTable(std::make_index_sequence<kFilterTypeCount>{});
     
-    if (!enableB) channels[0] = cv::Mat::zeros(input.size(), CV_8UC1);
-    if (!enableG) channels[1] = cv::Mat::zeros(input.size(), CV_8UC1);
-    if (!enableR) channels[2] = cv::Mat::zeros(input.size(), CV_8UC1);
+    std::size_t index = static_cast<std::size_t>(filter);
+    cv::Mat result = index < dispatch.size() ? dispatch[index](input, params) : input.clone();
     
-    cv::Mat result;
-    cv::merge(channels, result);
-    return result;
+    return applyChannelMode(result, channel);
+}
+
+uint64_t FilterManager::hashParams(const FilterParams& params) {
+    uint64_t hash = static_cast<uint64_t>(params.kernelSize);
+    hash = hashCombine(hash, static_cast<uint64_t>(params.brightnessValue));
+    hash = hashCombine(hash, std::hash<double>()(params.contrastValue));
+    hash = hashCombine(hash, (params.enableR ? 1u : 0u) | (params.enableG ? 2u : 0u) | (params.enableB ? 4u : 0u));
+    return hashCombine(hash, static_cast<uint64_t>(params.precision));
+}
+
+FilterParams FilterManager::scaleParams(const FilterParams& params, double scale, cv::Size size) {
+    FilterParams scaled = params;
+    scaled.kernelSize = std::max(1, static_cast<int>(std::lround(params.kernelSize * scale))) | 1;
+    if (params.faceMask && !params.faceMask->empty() && params.faceMask->size() != size) {
+        cv::Mat mask;
+        cv::resize(*params.faceMask, mask, size, 0.0, 0.0, cv::INTER_NEAREST);
+        scaled.faceMask = std::make_shared<const cv::Mat>(std::move(mask));
+    }
+    scaled.history.clear();
+    return scaled;
+}
+
+cv::Mat FilterManager::applyFilterAtScale(const cv::Mat& input, FilterType filter, const FilterParams& params, double scale) const {
+    if (input.empty() || filter == FilterType::NONE || scale >= 1.0) {
+        return applyFilter(input, filter, params);
+    }
+    cv::Mat small;
+    cv::resize(input, small, cv::Size(), scale, scale, cv::INTER_AREA);
+    cv::Mat filtered = applyFilter(small, filter, scaleParams(params, scale, small.size()));
+    cv::Mat output;
+    cv::resize(filtered, output, input.size(), 0.0, 0.0, cv::INTER_LINEAR);
+    return output;
 }
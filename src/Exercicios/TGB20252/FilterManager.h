@@ -2,28 +2,21 @@
 #define FILTER_MANAGER_H
 
 #include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <map>
 #include <vector>
+#include <utility>
 
-enum class FilterType {
-    NONE,
-    BILATERAL_FILTERING,
-    BOX_BLUR,
-    MEDIAN_BLUR,
-    PORTRAIT_BLUR,
-    SHARPEN,
-    LAPLACIAN,
-    SOBEL,
-    CANNY,
-    GRAYSCALE,
-    SEPIA,
-    INVERT,
-    BRIGHTNESS,
-    CONTRAST,
-    EMBOSS,
-    RGB_CHANNELS,
-    VHS
-};
+#include "FilterRegistry.h"
+#include "PixelPrecision.h"
+#include "PixelKernels.h"
+
+inline uint64_t hashCombine(uint64_t seed, uint64_t value) {
+    return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
 
 enum class ChannelMode {
     RGB,
@@ -33,53 +26,76 @@ enum class ChannelMode {
     GRAYSCALE
 };
 
-struct FilterInfo {
-    FilterType type;
-    std::string name;
-    std::string description;
+// Immutable copy of every value a filter may read. Copying only bumps the face mask refcount,
+// so one snapshot can be handed to several worker threads filtering frames or tiles.
+struct FilterParams {
+    int kernelSize{15};
+    int brightnessValue{50};
+    double contrastValue{1.5};
+    bool enableR{true};
+    bool enableG{true};
+    bool enableB{true};
+    IntermediatePrecision precision{IntermediatePrecision::FLOAT32};
+    std::shared_ptr<const cv::Mat> faceMask;
+    std::vector<cv::Mat> history; // previous raw frames, newest first; shared headers, read-only
+};
+
+// How a filter should be executed on this machine. Untuned plans keep the global defaults.
+struct ExecutionPlan {
+    bool tiled{true};
+    int threads{0};
+    CpuIsa isa{CpuIsa::SCALAR};
+    double milliseconds{0.0};
+    bool tuned{false};
 };
 
 class FilterManager {
 public:
     FilterManager();
     
-    cv::Mat applyFilter(const cv::Mat& input, FilterType filter, ChannelMode channel = ChannelMode::RGB);
-    std::vector<FilterInfo> getAvailableFilters() const;
-    std::string getFilterDescription(FilterType filter) const;
+    cv::Mat applyFilter(const cv::Mat& input, FilterType filter, ChannelMode channel = ChannelMode::RGB) const;
+    cv::Mat applyFilter(const cv::Mat& input, FilterType filter, const FilterParams& params, ChannelMode channel = ChannelMode::RGB) const;
+    // Filters a copy resized by scale and brings the result back to the input size (previews, load shedding)
+    cv::Mat applyFilterAtScale(const cv::Mat& input, FilterType filter, const FilterParams& params, double scale) const;
+    // Params for the same edit on a frame scale times larger: neighbourhoods scale, the face mask is
+    // resized to size and history frames (kept at the original size) are dropped
+    static FilterParams scaleParams(const FilterParams& params, double scale, cv::Size size);
+    // Hash of the user-set values; the face mask and history derive from the frame and are left out
+    static uint64_t hashParams(const FilterParams& params);
+    FilterParams snapshot() const;
+    const FilterList& getAvailableFilters() const;
+    const char* getFilterDescription(FilterType filter) const;
     
     void setKernelSize(int size);
     void setBrightnessValue(int value);
     void setContrastValue(double value);
-    void setFaceMask(const cv::Mat& mask);
+    void setPrecision(IntermediatePrecision precision);
+    void setFaceMask(cv::Mat mask);
+    void setHistory(std::vector<cv::Mat> frames);
     
     void setRGBChannels(bool r, bool g, bool b);
     void getRGBChannels(bool& r, bool& g, bool& b) const;
     
-private:
-    int kernelSize;
-    int brightnessValue;
-    double contrastValue;
-    cv::Mat faceMask;
+    // Fastest implementation measured by the Autotuner for a filter at a given frame size
+    void setExecutionPlan(FilterType filter, cv::Size size, const ExecutionPlan& plan);
+    ExecutionPlan executionPlan(FilterType filter, cv::Size size) const;
+    void clearExecutionPlans();
     
-    bool enableR, enableG, enableB;
+private:
+    mutable std::mutex paramsMutex;
+    FilterParams params;
+    std::map<std::pair<FilterType, std::pair<int, int>>, ExecutionPlan> plans;
     
-    cv::Mat applyChannelMode(const cv::Mat& input, ChannelMode channel);
-    cv::Mat gaussianBlur(const cv::Mat& input);
-    cv::Mat boxBlur(const cv::Mat& input);
-    cv::Mat medianBlur(const cv::Mat& input);
-    cv::Mat portraitBlur(const cv::Mat& input);
-    cv::Mat sharpen(const cv::Mat& input);
-    cv::Mat laplacian(const cv::Mat& input);
-    cv::Mat sobel(const cv::Mat& input);
-    cv::Mat canny(const cv::Mat& input);
-    cv::Mat grayscale(const cv::Mat& input);
-    cv::Mat sepia(const cv::Mat& input);
-    cv::Mat invert(const cv::Mat& input);
-    cv::Mat brightness(const cv::Mat& input);
-    cv::Mat contrast(const cv::Mat& input);
-    cv::Mat emboss(const cv::Mat& input);
-    cv::Mat rgbChannels(const cv::Mat& input);
-    cv::Mat vhs(const cv::Mat& input);
+    using Kernel = cv::Mat (*)(const cv::Mat&, const FilterParams&);
+
+    static cv::Mat applyChannelMode(const cv::Mat& input, ChannelMode channel);
+
+    template <FilterType F>
+    static cv::Mat run(const cv::Mat& input, const FilterParams& params);
+    template <FilterType F>
+    static cv::Mat kernel(const cv::Mat& input, const FilterParams& params);
+    template <std::size_t... I>
+    static constexpr std::array<Kernel, sizeof...(I)> makeDispatchTable(std::index_sequence<I...>);
 };
 
 #endif
@@ -0,0 +1,183 @@
+#include "FilterPreviewStrip.h"
+#include <algorithm>
+#include <iostream>
+
+FilterPreviewStrip::FilterPreviewStrip(const FilterManager& filters, cv::Size thumbSize, int workers)
+    : filterManager(filters),
+      thumb(thumbSize),
+      workerCount(workers > 0 ? workers : std::max(1, std::min(4, static_cast<int>(std::thread::hardware_concurrency()) / 2))) {
+    cells.push_back(FilterType::NONE);
+    for (const auto& info : filters.getAvailableFilters()) {
+        cells.push_back(info.type);
+    }
+    atlas = cv::Mat(thumb.height, thumb.width * static_cast<int>(cells.size()), CV_8UC3, cv::Scalar::all(0));
+}
+
+FilterPreviewStrip::~FilterPreviewStrip() {
+    stop();
+}
+
+void FilterPreviewStrip::setBudget(double milliseconds) {
+    std::lock_guard<std::mutex> lock(mutex);
+    budgetMs = std::max(1.0, milliseconds);
+}
+
+void FilterPreviewStrip::setRefreshInterval(double seconds) {
+    std::lock_guard<std::mutex> lock(mutex);
+    refreshInterval = std::max(0.0, seconds);
+}
+
+bool FilterPreviewStrip::roundActive() const {
+    return nextTask < taskCount || active > 0 || uploadPending;
+}
+
+bool FilterPreviewStrip::submit(const cv::Mat& frame, const FilterParams& frameParams, uint64_t key, double timestamp) {
+    if (frame.empty()) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (roundActive() || timestamp - lastSubmit < refreshInterval) {
+            return false;
+        }
+        if (key != lastKey) {
+            lastKey = key;
+            remaining = static_cast<int>(cells.size());
+        }
+        if (remaining == 0) {
+            return false;
+        }
+    }
+
+    // Every filter of the round reads the same small copy, so the downscale is paid once
+    cv::Mat small;
+    cv::resize(frame, small, thumb, 0.0, 0.0, cv::INTER_AREA);
+    if (small.channels() == 1) {
+        cv::cvtColor(small, small, cv::COLOR_GRAY2BGR);
+    }
+    double scale = static_cast<double>(thumb.width) / frame.cols;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        source = small;
+        params = FilterManager::scaleParams(frameParams, scale, thumb);
+        nextTask = 0;
+        taskCount = remaining;
+        finished = 0;
+        deadline = cv::getTickCount() + static_cast<int64>(budgetMs * cv::getTickFrequency() / 1000.0);
+        lastSubmit = timestamp;
+        if (!running) {
+            running = true;
+            for (int i = 0; i < workerCount; ++i) {
+                workers.emplace_back(&FilterPreviewStrip::workerLoop, this);
+            }
+        }
+    }
+    wake.notify_all();
+    return true;
+}
+
+void FilterPreviewStrip::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return !running || nextTask < taskCount; });
+        if (!running) {
+            break;
+        }
+        int cellCount = static_cast<int>(cells.size());
+        if (nextTask > 0 && cv::getTickCount() > deadline) {
+            // Out of budget: close the round here; the unstarted cells lead the next one
+            startCell = (startCell + nextTask) % cellCount;
+            taskCount = nextTask;
+        } else {
+            int cell = (startCell + nextTask++) % cellCount;
+            ++active;
+            FilterType filter = cells[cell];
+            cv::Mat input = source;
+            FilterParams roundParams = params;
+            lock.unlock();
+
+            try {
+                cv::Mat result = filter == FilterType::NONE ? input : filterManager.applyFilter(input, filter, roundParams);
+                if (result.channels() == 1) {
+                    cv::cvtColor(result, result, cv::COLOR_GRAY2BGR);
+                }
+                if (result.size() != thumb) {
+                    cv::resize(result, result, thumb, 0.0, 0.0, cv::INTER_AREA);
+                }
+                result.copyTo(atlas(cv::Rect(cell * thumb.width, 0, thumb.width, thumb.height)));
+            } catch (const cv::Exception& e) {
+                std::cerr << "Preview of " << filterInfo(filter).name << " failed: " << e.what() << std::endl;
+            }
+
+            lock.lock();
+            --active;
+            ++finished;
+        }
+
+        if (nextTask >= taskCount && active == 0 && !uploadPending) {
+            if (taskCount == remaining) {
+                startCell = (startCell + taskCount) % cellCount;
+            }
+            remaining -= finished;
+            uploadPending = true;
+        }
+    }
+}
+
+void FilterPreviewStrip::upload() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!uploadPending) {
+        return;
+    }
+    if (!textureCreated) {
+        atlasTexture.createTexture(atlas.cols, atlas.rows);
+        textureCreated = true;
+    }
+    atlasTexture.updateTexture(atlas);
+    uploadPending = false;
+    taskCount = nextTask = 0;
+}
+
+bool FilterPreviewStrip::busy() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return roundActive();
+}
+
+GLuint FilterPreviewStrip::texture() const {
+    return atlasTexture.getTextureID();
+}
+
+int FilterPreviewStrip::cellCount() const {
+    return static_cast<int>(cells.size());
+}
+
+FilterType FilterPreviewStrip::filterAt(int cell) const {
+    return cells[cell];
+}
+
+cv::Size FilterPreviewStrip::thumbSize() const {
+    return thumb;
+}
+
+void FilterPreviewStrip::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers.clear();
+    std::lock_guard<std::mutex> lock(mutex);
+    taskCount = nextTask = active = 0;
+    uploadPending = false;
+}
+
+void FilterPreviewStrip::cleanup() {
+    atlasTexture.cleanup();
+    textureCreated = false;
+}
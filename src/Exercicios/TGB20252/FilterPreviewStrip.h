@@ -0,0 +1,77 @@
+#ifndef FILTER_PREVIEW_STRIP_H
+#define FILTER_PREVIEW_STRIP_H
+
+#include <opencv2/opencv.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "FilterManager.h"
+#include "TextureManager.h"
+
+// One live thumbnail per filter, laid out side by side in a single atlas texture. A round filters a
+// thumbnail-sized copy of the frame on a small worker pool; cells that have not started when the
+// round's time budget runs out keep their previous picture and go first in the next round.
+// Rounds start at most every refreshInterval seconds, and not at all while nothing changed.
+class FilterPreviewStrip {
+public:
+    explicit FilterPreviewStrip(const FilterManager& filters, cv::Size thumbSize = cv::Size(72, 128), int workers = 0);
+    ~FilterPreviewStrip();
+
+    void setBudget(double milliseconds);
+    void setRefreshInterval(double seconds);
+
+    // key identifies frame and parameters; returns true if a round was started
+    bool submit(const cv::Mat& frame, const FilterParams& params, uint64_t key, double timestamp);
+    // Render thread: uploads the atlas after a round finished; needs the GL context
+    void upload();
+    bool busy() const;
+
+    GLuint texture() const;
+    int cellCount() const;
+    FilterType filterAt(int cell) const;
+    cv::Size thumbSize() const;
+
+    void stop();
+    void cleanup();
+
+private:
+    const FilterManager& filterManager;
+    std::vector<FilterType> cells;
+    cv::Size thumb;
+    int workerCount;
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<std::thread> workers;
+    bool running{false};
+
+    // Round state; the atlas pixels are written by workers (disjoint cells) and read by upload()
+    // only once active == 0 and every task has been handed out
+    cv::Mat atlas;
+    cv::Mat source;
+    FilterParams params;
+    int startCell{0};
+    int nextTask{0};
+    int taskCount{0};
+    int active{0};
+    int finished{0};
+    int64 deadline{0};
+    bool uploadPending{false};
+
+    uint64_t lastKey{0};
+    int remaining{0};
+    double lastSubmit{-1e9};
+    double budgetMs{10.0};
+    double refreshInterval{0.2};
+
+    TextureManager atlasTexture;
+    bool textureCreated{false};
+
+    void workerLoop();
+    bool roundActive() const;
+};
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef FILTER_REGISTRY_H
+#define FILTER_REGISTRY_H
+
+#include <array>
+#include <cstddef>
+
+enum class FilterType {
+    NONE,
+    BILATERAL_FILTERING,
+    BOX_BLUR,
+    MEDIAN_BLUR,
+    PORTRAIT_BLUR,
+    SHARPEN,
+    LAPLACIAN,
+    SOBEL,
+    CANNY,
+    GRAYSCALE,
+    SEPIA,
+    INVERT,
+    BRIGHTNESS,
+    CONTRAST,
+    EMBOSS,
+    RGB_CHANNELS,
+    GHOST_TRAIL,
+    TEMPORAL_DENOISE,
+    VHS
+};
+
+inline constexpr std::size_t kFilterTypeCount = static_cast<std::size_t>(FilterType::VHS) + 1;
+
+// Bit flags describing which FilterManager parameters a filter reads
+enum FilterParam : unsigned {
+    PARAM_NONE = 0,
+    PARAM_KERNEL_SIZE = 1u << 0,
+    PARAM_BRIGHTNESS = 1u << 1,
+    PARAM_CONTRAST = 1u << 2,
+    PARAM_RGB_TOGGLES = 1u << 3
+};
+
+// Halo radius placeholder for filters whose footprint follows the kernel size parameter
+inline constexpr int kKernelSizeHalo = -1;
+
+struct FilterTraits {
+    bool pointOp;             // output pixel depends only on the same input pixel
+    bool separable;           // kernel runs as a row pass followed by a column pass
+    bool needsGray;           // kernel works on luma, the gray conversion is hoisted by the dispatcher
+    bool needsFaceMask;       // reads the face mask set by the face detector
+    bool singleChannelOutput; // result is CV_8UC1
+    bool frameGlobal;         // needs frame-wide statistics, cannot run on independent strips
+    int haloRadius;           // extra rows/cols of context needed around a region
+    int historyFrames{0};     // previous raw frames read from FilterParams::history
+};
+
+struct FilterInfo {
+    FilterType type;
+    const char* name;
+    const char* description;
+    unsigned params;
+    FilterTraits traits;
+};
+
+inline constexpr FilterTraits kPointOp{true, false, false, false, false, false, 0};
+
+inline constexpr FilterInfo kNoFilterInfo{FilterType::NONE, "Sem filtro", "Sem efeito aplicado", PARAM_NONE, kPointOp};
+
+using FilterList = std::array<FilterInfo, kFilterTypeCount - 1>;
+
+// Menu order; the dispatcher indexes by FilterType, not by position in this table
+inline constexpr FilterList kFilterRegistry{{
+    {FilterType::PORTRAIT_BLUR, "Portrait", "Simula modo retrato com fundo desfocado e rosto nitido.",
+        PARAM_NONE, {false, true, false, true, false, false, 50}},
+    {FilterType::BILATERAL_FILTERING, "Bilateral Filtering", "Suaviza pele e fundo mantendo contornos definidos.",
+        PARAM_NONE, {false, false, false, false, false, false, 7}},
+    {FilterType::BOX_BLUR, "Box Blur", "Desfoca uniformemente a imagem.",
+        PARAM_KERNEL_SIZE, {false, true, false, false, false, false, kKernelSizeHalo}},
+    {FilterType::MEDIAN_BLUR, "Median Blur", "Reduz ruído preservando bordas.",
+        PARAM_KERNEL_SIZE, {false, false, false, false, false, false, kKernelSizeHalo}},
+    {FilterType::SHARPEN, "Sharpen", "Destaca bordas e realca detalhes finos.",
+        PARAM_NONE, {false, true, false, false, false, false, 9}},
+    {FilterType::LAPLACIAN, "Laplacian", "Realça áreas de transição rápida de intensidade.",
+        PARAM_NONE, {false, false, true, false, true, false, 1}},
+    {FilterType::SOBEL, "Sobel", "Detecta bordas horizontais e verticais.",
+        PARAM_NONE, {false, true, true, false, true, false, 1}},
+    {FilterType::CANNY, "Canny Edge", "Extrai bordas com alta precisão.",
+        PARAM_NONE, {false, false, true, false, true, true, 2}},
+    {FilterType::GRAYSCALE, "B&W", "Converte para tons de cinza equilibrados.",
+        PARAM_NONE, {true, false, true, false, true, false, 0}},
+    {FilterType::SEPIA, "Vintage", "Aplica tonalidade quente inspirada em filme antigo.",
+        PARAM_NONE, kPointOp},
+    {FilterType::INVERT, "Negative", "Inverte as cores para um efeito experimental.",
+        PARAM_NONE, kPointOp},
+    {FilterType::BRIGHTNESS, "Bright", "Eleva o brilho geral de maneira suave.",
+        PARAM_BRIGHTNESS, kPointOp},
+    {FilterType::CONTRAST, "Contrast", "Amplifica contraste e profundidade.",
+        PARAM_CONTRAST, kPointOp},
+    {FilterType::EMBOSS, "Emboss", "Cria relevo simulando iluminação lateral.",
+        PARAM_NONE, {false, false, false, false, false, false, 1}},
+    {FilterType::RGB_CHANNELS, "RGB", "Liga ou desliga rapidamente cada canal de cor.",
+        PARAM_RGB_TOGGLES, kPointOp},
+    {FilterType::GHOST_TRAIL, "Ghost Trail", "Deixa um rastro dos quadros anteriores sobre o movimento.",
+        PARAM_NONE, {true, false, false, false, false, false, 0, 4}},
+    {FilterType::TEMPORAL_DENOISE, "Denoise", "Reduz ruido combinando quadros anteriores parecidos.",
+        PARAM_NONE, {true, false, false, false, false, false, 0, 4}},
+    {FilterType::VHS, "VHS", "Simula fita analogica com bleed, scanlines e ruido.",
+        PARAM_NONE, {false, false, false, false, false, true, 13, 1}}
+}};
+
+constexpr const FilterInfo& filterInfo(FilterType type) {
+    for (const auto& info : kFilterRegistry) {
+        if (info.type == type) {
+            return info;
+        }
+    }
+    return kNoFilterInfo;
+}
+
+template <FilterType F>
+inline constexpr FilterTraits filterTraits = filterInfo(F).traits;
+
+constexpr int maxHistoryFrames() {
+    int frames = 0;
+    for (const auto& info : kFilterRegistry) {
+        frames = info.traits.historyFrames > frames ? info.traits.historyFrames : frames;
+    }
+    return frames;
+}
+
+constexpr int filterHaloRadius(FilterType type, int kernelSize) {
+    int halo = filterInfo(type).traits.haloRadius;
+    return halo == kKernelSizeHalo ? kernelSize / 2 : halo;
+}
+
+#endif
@@ -0,0 +1,238 @@
+#include "FrameCache.h"
+#include "FramePool.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace {
+size_t frameBytes(const CachedFrame& frame) {
+    return frame.source.total() * frame.source.elemSize() + frame.display.total() * frame.display.elemSize() +
+           frame.planar.total() * frame.planar.elemSize();
+}
+}
+
+FrameCache::FrameCache(FrameSource& frameSource, FrameTransform frameTransform, size_t budgetBytes, int frames)
+    : source(frameSource),
+      transform(std::move(frameTransform)),
+      budget(budgetBytes),
+      lookahead(std::max(1, frames)),
+      count(frameSource.frameCount()),
+      decodePosition(frameSource.position()) {
+    worker = std::thread(&FrameCache::workerLoop, this);
+}
+
+FrameCache::~FrameCache() {
+    stop();
+}
+
+void FrameCache::setPlayhead(int64_t index, int travel) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (index == playhead && travel == direction) {
+        return;
+    }
+    playhead = index;
+    direction = travel < 0 ? -1 : 1;
+    wake.notify_one();
+}
+
+bool FrameCache::fetch(int64_t index, CachedFrame& frame) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = lookup.find(index);
+    if (found == lookup.end()) {
+        return false;
+    }
+    entries.splice(entries.begin(), entries, found->second);
+    frame = found->second->frame;
+    return true;
+}
+
+bool FrameCache::waitFor(int64_t index, CachedFrame& frame, int timeoutMs) {
+    std::unique_lock<std::mutex> lock(mutex);
+    bool found = ready.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                                [this, index] { return !running || lookup.count(index) > 0; });
+    if (!found || !running) {
+        return false;
+    }
+    frame = lookup[index]->frame;
+    return true;
+}
+
+int64_t FrameCache::frameCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return count;
+}
+
+int FrameCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<int>(entries.size());
+}
+
+size_t FrameCache::bytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return used;
+}
+
+int64_t FrameCache::decoded() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return decodedFrames;
+}
+
+int64_t FrameCache::seeks() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return seekCount;
+}
+
+void FrameCache::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    wake.notify_one();
+    ready.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+// Walks the window in playback order, wrapping at either end, and returns the first frame to decode
+int64_t FrameCache::firstMissing() const {
+    if (count <= 0) {
+        return -1;
+    }
+    for (int step = 0; step <= lookahead; ++step) {
+        int64_t index = ((playhead + direction * step) % count + count) % count;
+        if (lookup.count(index) == 0) {
+            return index;
+        }
+    }
+    return -1;
+}
+
+// Frames decoded on the way to a missing one are only kept (and transformed) when playback will
+// show them: inside the window, or in the block a reverse pass is filling
+bool FrameCache::wanted(int64_t index) const {
+    if (count <= 0) {
+        return true;
+    }
+    int64_t ahead = (((index - playhead) * direction) % count + count) % count;
+    return ahead <= lookahead || (index >= keepFrom && index <= keepTo);
+}
+
+// How many frames a reverse pass can keep, from the average size of the frames cached so far
+int64_t FrameCache::reverseSpan() const {
+    if (entries.empty() || used == 0) {
+        return lookahead;
+    }
+    size_t perFrame = std::max<size_t>(1, used / entries.size());
+    return std::max<int64_t>(lookahead, static_cast<int64_t>(budget / perFrame) - 2);
+}
+
+void FrameCache::insert(int64_t index, CachedFrame& frame) {
+    auto found = lookup.find(index);
+    if (found != lookup.end()) {
+        used -= found->second->bytes;
+        entries.erase(found->second);
+        lookup.erase(found);
+    }
+    size_t size = frameBytes(frame);
+    entries.push_front({index, frame, size});
+    lookup[index] = entries.begin();
+    used += size;
+
+    // Never below the two windows around the playhead, or playback would evict what it is about to show
+    size_t minimum = static_cast<size_t>(2 * lookahead + 2);
+    while (used > budget && entries.size() > minimum) {
+        Entry& oldest = entries.back();
+        used -= oldest.bytes;
+        lookup.erase(oldest.index);
+        if (spare.size() < 2) {
+            spare.push_back(oldest.frame);
+        }
+        entries.pop_back();
+    }
+}
+
+void FrameCache::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        int64_t missing = -1;
+        wake.wait(lock, [this, &missing] {
+            missing = firstMissing();
+            return !running || missing >= 0;
+        });
+        if (!running) {
+            break;
+        }
+
+        // Decoding on from where the source stands beats a seek unless the frame is behind it, or a
+        // long gap can be cut short by a later keyframe. After a seek the source decodes forward
+        // until the missing frame is in, however far it is from the keyframe.
+        int64_t seekTo = -1;
+        if (decodePosition < 0 || missing < decodePosition) {
+            int64_t blockStart = direction < 0 ? std::max<int64_t>(0, missing - lookahead + 1) : missing;
+            seekTo = source.keyframeBefore(blockStart);
+        } else if (missing - decodePosition > lookahead && source.keyframeBefore(missing) > decodePosition) {
+            seekTo = source.keyframeBefore(missing);
+        }
+        if (seekTo >= 0) {
+            // A reverse pass keeps the newest frames before the missing one, as many as fit
+            keepFrom = direction < 0 ? std::max(seekTo, missing - reverseSpan() + 1) : 0;
+            keepTo = direction < 0 ? missing : -1;
+        }
+        int64_t next = seekTo >= 0 ? seekTo : decodePosition;
+        bool keep = wanted(next) && lookup.count(next) == 0;
+
+        // Recycle an evicted frame's buffers when nobody else holds them anymore
+        CachedFrame frame;
+        while (keep && !spare.empty()) {
+            CachedFrame candidate = spare.back();
+            spare.pop_back();
+            if (!FramePool::isShared(candidate.source) && !FramePool::isShared(candidate.display) &&
+                !FramePool::isShared(candidate.planar)) {
+                frame = candidate;
+                break;
+            }
+        }
+        lock.unlock();
+
+        bool ok = true;
+        if (seekTo >= 0) {
+            ok = source.seek(seekTo);
+        }
+        cv::Mat decoded;
+        int64_t index = -1;
+        if (ok && source.read(decoded) && !decoded.empty()) {
+            index = source.position() - 1;
+            // A source that landed somewhere else than expected: keep what it gave
+            keep = keep || index != next;
+            try {
+                if (keep) {
+                    transform(decoded, frame);
+                }
+            } catch (const cv::Exception& e) {
+                std::cerr << "Frame " << index << " could not be prepared: " << e.what() << std::endl;
+                index = -1;
+            }
+        }
+
+        lock.lock();
+        if (seekTo >= 0) {
+            ++seekCount;
+        }
+        count = source.frameCount();
+        decodePosition = source.position();
+        if (index < 0) {
+            // Unreadable frame or failed seek: back off instead of spinning on it
+            lock.unlock();
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            lock.lock();
+            decodePosition = -1;
+            continue;
+        }
+        ++decodedFrames;
+        if (keep) {
+            insert(index, frame);
+            ready.notify_all();
+        }
+    }
+}
@@ -0,0 +1,93 @@
+#ifndef FRAME_CACHE_H
+#define FRAME_CACHE_H
+
+#include <opencv2/opencv.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "FrameSource.h"
+
+// A frame as decoded, plus the display frame the handler's transform made from it: BGR in display,
+// or for planar sources the display-size planes in planar, left for the GPU to convert
+struct CachedFrame {
+    cv::Mat source;
+    cv::Mat display;
+    cv::Mat planar;
+};
+
+// Fills out from a decoded frame; buffers already in out have the right size when recycled
+using FrameTransform = std::function<void(const cv::Mat& decoded, CachedFrame& out)>;
+
+// LRU of transformed frames around the playhead of a random-access FrameSource. A decode thread
+// owns the source and keeps the next lookahead frames in the direction of travel cached, wrapping
+// at the end, so looping, scrubbing back and reverse play are cache hits instead of seeks.
+// Frames are decoded forward from a keyframe. For reverse play one pass keeps every frame from the
+// keyframe up to the wanted one that fits in the budget, so a GOP is decoded once per budget-full
+// of frames instead of once per lookahead block.
+class FrameCache {
+public:
+    FrameCache(FrameSource& source, FrameTransform transform, size_t budgetBytes, int lookahead = 12);
+    ~FrameCache();
+
+    // direction is +1 or -1
+    void setPlayhead(int64_t index, int direction);
+    // Render thread: never waits; false when the frame is not decoded yet
+    bool fetch(int64_t index, CachedFrame& frame);
+    // Waits up to timeoutMs for the frame, for the first frame after opening
+    bool waitFor(int64_t index, CachedFrame& frame, int timeoutMs);
+
+    int64_t frameCount() const;
+    int size() const;
+    size_t bytes() const;
+    int64_t decoded() const;
+    int64_t seeks() const;
+
+    void stop();
+
+private:
+    struct Entry {
+        int64_t index;
+        CachedFrame frame;
+        size_t bytes;
+    };
+
+    FrameSource& source;
+    FrameTransform transform;
+    size_t budget;
+    int lookahead;
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable ready;
+    std::thread worker;
+    bool running{true};
+
+    std::list<Entry> entries;  // most recently used first
+    std::unordered_map<int64_t, std::list<Entry>::iterator> lookup;
+    std::vector<CachedFrame> spare;
+    size_t used{0};
+
+    int64_t count;
+    int64_t playhead{0};
+    int direction{1};
+    int64_t decodePosition{0};
+    int64_t decodedFrames{0};
+    int64_t seekCount{0};
+    // Frames the current reverse pass keeps besides the playback window; empty when keepTo < keepFrom
+    int64_t keepFrom{0};
+    int64_t keepTo{-1};
+
+    void workerLoop();
+    int64_t firstMissing() const;
+    bool wanted(int64_t index) const;
+    int64_t reverseSpan() const;
+    void insert(int64_t index, CachedFrame& frame);
+};
+
+#endif
@@ -0,0 +1,105 @@
+#include "FrameGovernor.h"
+#include <algorithm>
+
+namespace {
+const double kSmoothing = 0.1;
+// Degrade after ~1/6 s over budget, restore after ~1 s below 70% of it
+const int kSlowFramesToDegrade = 10;
+const int kFastFramesToRestore = 60;
+const double kRestoreHeadroom = 0.7;
+}
+
+FrameGovernor::FrameGovernor(double budgetMs) : budgetMs(budgetMs) {}
+
+void FrameGovernor::setEnabled(bool value) {
+    enabled = value;
+    if (!enabled) {
+        currentLevel = 0;
+        slowFrames = fastFrames = 0;
+    }
+}
+
+bool FrameGovernor::isEnabled() const {
+    return enabled;
+}
+
+void FrameGovernor::setBudget(double milliseconds) {
+    budgetMs = std::max(1.0, milliseconds);
+}
+
+double FrameGovernor::getBudget() const {
+    return budgetMs;
+}
+
+void FrameGovernor::beginFrame() {
+    current.fill(0.0);
+}
+
+void FrameGovernor::record(GovernorStage stage, double milliseconds) {
+    current[static_cast<int>(stage)] += milliseconds;
+}
+
+void FrameGovernor::endFrame() {
+    double total = 0.0;
+    for (int i = 0; i < kStages; ++i) {
+        average[i] += (current[i] - average[i]) * kSmoothing;
+        total += current[i];
+    }
+    averageFrame += (total - averageFrame) * kSmoothing;
+
+    if (!enabled) {
+        return;
+    }
+
+    if (averageFrame > budgetMs) {
+        fastFrames = 0;
+        if (++slowFrames >= kSlowFramesToDegrade && currentLevel < static_cast<int>(Degradation::COUNT)) {
+            ++currentLevel;
+            slowFrames = 0;
+        }
+    } else if (averageFrame < budgetMs * kRestoreHeadroom) {
+        slowFrames = 0;
+        if (++fastFrames >= kFastFramesToRestore && currentLevel > 0) {
+            --currentLevel;
+            fastFrames = 0;
+        }
+    } else {
+        slowFrames = fastFrames = 0;
+    }
+}
+
+int FrameGovernor::level() const {
+    return currentLevel;
+}
+
+bool FrameGovernor::active(Degradation degradation) const {
+    return enabled && currentLevel > static_cast<int>(degradation);
+}
+
+double FrameGovernor::stageMs(GovernorStage stage) const {
+    return average[static_cast<int>(stage)];
+}
+
+double FrameGovernor::frameMs() const {
+    return averageFrame;
+}
+
+const char* FrameGovernor::stageName(GovernorStage stage) {
+    switch (stage) {
+        case GovernorStage::FACE: return "Face";
+        case GovernorStage::FILTER: return "Filter";
+        case GovernorStage::STICKERS: return "Stickers";
+        case GovernorStage::UPLOAD: return "Upload";
+        default: return "?";
+    }
+}
+
+const char* FrameGovernor::degradationName(Degradation degradation) {
+    switch (degradation) {
+        case Degradation::FACE_SKIP: return "Face detection every 4th frame";
+        case Degradation::STICKER_PREVIEW: return "Sticker preview hidden";
+        case Degradation::CHEAP_FILTER: return "Cheaper filter settings";
+        case Degradation::HALF_RESOLUTION: return "Half-resolution filtering";
+        default: return "?";
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef FRAME_GOVERNOR_H
+#define FRAME_GOVERNOR_H
+
+#include <opencv2/opencv.hpp>
+#include <array>
+
+enum class GovernorStage {
+    FACE = 0,
+    FILTER,
+    STICKERS,
+    UPLOAD,
+    COUNT
+};
+
+// Optional quality, in the order it is given up when frames run over budget
+enum class Degradation {
+    FACE_SKIP = 0,      // detect faces every few frames and reuse the last mask in between
+    STICKER_PREVIEW,    // hide the translucent sticker under the cursor
+    CHEAP_FILTER,       // cap neighbourhood sizes and use fixed-point intermediates
+    HALF_RESOLUTION,    // filter at half width/height and upscale
+    COUNT
+};
+
+// Watches how long each pipeline stage takes and sheds optional work when the CPU side of a frame
+// no longer fits the vsync budget. Levels step one at a time: up after a short run of slow frames,
+// down only after a long run with clear headroom, so quality does not oscillate.
+class FrameGovernor {
+public:
+    explicit FrameGovernor(double budgetMs = 1000.0 / 60.0);
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+    void setBudget(double milliseconds);
+    double getBudget() const;
+
+    void beginFrame();
+    void record(GovernorStage stage, double milliseconds);
+    void endFrame();
+
+    int level() const;
+    bool active(Degradation degradation) const;
+    double stageMs(GovernorStage stage) const;
+    double frameMs() const;
+
+    static const char* stageName(GovernorStage stage);
+    static const char* degradationName(Degradation degradation);
+
+private:
+    static constexpr int kStages = static_cast<int>(GovernorStage::COUNT);
+
+    bool enabled{true};
+    double budgetMs;
+    std::array<double, kStages> current{};
+    std::array<double, kStages> average{};
+    double averageFrame{0.0};
+    int currentLevel{0};
+    int slowFrames{0};
+    int fastFrames{0};
+};
+
+// Adds the lifetime of the scope to a stage of the current frame
+class StageTimer {
+public:
+    StageTimer(FrameGovernor& governor, GovernorStage stage)
+        : governor(governor), stage(stage), start(cv::getTickCount()) {}
+    ~StageTimer() {
+        governor.record(stage, (cv::getTickCount() - start) * 1000.0 / cv::getTickFrequency());
+    }
+
+private:
+    FrameGovernor& governor;
+    GovernorStage stage;
+    int64 start;
+};
+
+#endif
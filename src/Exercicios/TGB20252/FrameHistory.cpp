@@ -0,0 +1,53 @@
+#include "FrameHistory.h"
+#include <algorithm>
+
+FrameHistory::FrameHistory(int capacity) : slots(std::max(1, capacity)) {}
+
+void FrameHistory::push(const cv::Mat& raw, const cv::Mat& processed, double timestamp) {
+    head = (head + 1) % static_cast<int>(slots.size());
+    HistoryFrame& slot = slots[head];
+    // Overwriting the headers releases the evicted frame's buffers back to whoever pools them
+    slot.raw = raw;
+    slot.processed = processed;
+    slot.id = nextId++;
+    slot.timestamp = timestamp;
+    count = std::min(count + 1, static_cast<int>(slots.size()));
+}
+
+void FrameHistory::clear() {
+    for (auto& slot : slots) {
+        slot = HistoryFrame{};
+    }
+    head = 0;
+    count = 0;
+}
+
+void FrameHistory::setCapacity(int capacity) {
+    capacity = std::max(1, capacity);
+    std::vector<HistoryFrame> resized(capacity);
+    int kept = std::min(count, capacity);
+    for (int age = kept - 1; age >= 0; --age) {
+        resized[kept - 1 - age] = at(age);
+    }
+    slots.swap(resized);
+    head = std::max(0, kept - 1);
+    count = kept;
+}
+
+int FrameHistory::size() const {
+    return count;
+}
+
+int FrameHistory::capacity() const {
+    return static_cast<int>(slots.size());
+}
+
+bool FrameHistory::empty() const {
+    return count == 0;
+}
+
+const HistoryFrame& FrameHistory::at(int age) const {
+    CV_Assert(age >= 0 && age < count);
+    int index = (head - age + static_cast<int>(slots.size())) % static_cast<int>(slots.size());
+    return slots[index];
+}
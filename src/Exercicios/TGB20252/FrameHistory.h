@@ -0,0 +1,39 @@
+#ifndef FRAME_HISTORY_H
+#define FRAME_HISTORY_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <vector>
+
+struct HistoryFrame {
+    cv::Mat raw;
+    cv::Mat processed;
+    uint64_t id{0};
+    double timestamp{0.0};
+};
+
+// Fixed-capacity ring of the last frames that went through the pipeline. Entries are cv::Mat headers,
+// so pushing and reading only move reference counts; the pixels must not be written after push().
+class FrameHistory {
+public:
+    explicit FrameHistory(int capacity = 8);
+
+    void push(const cv::Mat& raw, const cv::Mat& processed, double timestamp);
+    void clear();
+    void setCapacity(int capacity);
+
+    int size() const;
+    int capacity() const;
+    bool empty() const;
+
+    // age 0 is the newest frame
+    const HistoryFrame& at(int age) const;
+
+private:
+    std::vector<HistoryFrame> slots;
+    int head{0};
+    int count{0};
+    uint64_t nextId{1};
+};
+
+#endif
@@ -0,0 +1,160 @@
+#include "FrameOrienter.h"
+
+namespace {
+// Output pixel centres are scaled into the rotated frame exactly as cv::resize does for
+// INTER_LINEAR, then taken back to the decoded frame through the inverse rotation, so the
+// result matches rotate-then-resize up to the 1/32 pixel precision of the fixed-point maps
+void buildMaps(Orientation rotation, cv::Size input, cv::Size output, cv::Mat& map1, cv::Mat& map2) {
+    bool quarter = rotation == Orientation::CW90 || rotation == Orientation::CCW90;
+    cv::Size rotated = quarter ? cv::Size(input.height, input.width) : input;
+    float scaleX = static_cast<float>(rotated.width) / output.width;
+    float scaleY = static_cast<float>(rotated.height) / output.height;
+    float lastX = static_cast<float>(input.width - 1);
+    float lastY = static_cast<float>(input.height - 1);
+
+    cv::Mat mapX(output, CV_32FC1);
+    cv::Mat mapY(output, CV_32FC1);
+    for (int y = 0; y < output.height; ++y) {
+        float* rowX = mapX.ptr<float>(y);
+        float* rowY = mapY.ptr<float>(y);
+        float v = (y + 0.5f) * scaleY - 0.5f;
+        for (int x = 0; x < output.width; ++x) {
+            float u = (x + 0.5f) * scaleX - 0.5f;
+            switch (rotation) {
+                case Orientation::CCW90: rowX[x] = lastX - v; rowY[x] = u; break;
+                case Orientation::CW90: rowX[x] = v; rowY[x] = lastY - u; break;
+                case Orientation::ROT180: rowX[x] = lastX - u; rowY[x] = lastY - v; break;
+                default: rowX[x] = u; rowY[x] = v; break;
+            }
+        }
+    }
+    cv::convertMaps(mapX, mapY, map1, map2, CV_16SC2);
+}
+}
+
+bool parseOrientation(const std::string& text, Orientation& orientation) {
+    if (text == "none") {
+        orientation = Orientation::NONE;
+    } else if (text == "cw") {
+        orientation = Orientation::CW90;
+    } else if (text == "ccw") {
+        orientation = Orientation::CCW90;
+    } else if (text == "180") {
+        orientation = Orientation::ROT180;
+    } else if (text == "auto") {
+        orientation = Orientation::AUTO;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+FrameOrienter::FrameOrienter(Orientation orientation, cv::Size outputSize)
+    : requested(orientation), output(outputSize) {}
+
+void FrameOrienter::configure(Orientation orientation, cv::Size outputSize) {
+    std::lock_guard<std::mutex> lock(mutex);
+    requested = orientation;
+    output = outputSize;
+    mappedInput = cv::Size();
+    planarInput = cv::Size();
+}
+
+Orientation FrameOrienter::orientation() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return requested;
+}
+
+cv::Size FrameOrienter::outputSize() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return output;
+}
+
+Orientation FrameOrienter::resolve(cv::Size input) const {
+    if (requested != Orientation::AUTO) {
+        return requested;
+    }
+    bool inputPortrait = input.height > input.width;
+    bool outputPortrait = output.height > output.width;
+    return inputPortrait == outputPortrait ? Orientation::NONE : Orientation::CCW90;
+}
+
+void FrameOrienter::apply(const cv::Mat& src, cv::Mat& dst) {
+    if (src.empty()) {
+        return;
+    }
+    cv::Mat fixedMap;
+    cv::Mat fractionMap;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (src.size() != mappedInput) {
+            buildMaps(resolve(src.size()), src.size(), output, map1, map2);
+            mappedInput = src.size();
+        }
+        fixedMap = map1;
+        fractionMap = map2;
+    }
+    dst.create(fixedMap.size(), src.type());
+    cv::remap(src, dst, fixedMap, fractionMap, cv::INTER_LINEAR, cv::BORDER_REPLICATE);
+}
+
+void FrameOrienter::applyPlanar(const cv::Mat& src, PixelLayout layout, cv::Mat& dst) {
+    if (src.empty()) {
+        return;
+    }
+    cv::Size input(src.cols, src.rows * 2 / 3);
+    cv::Mat lumaFixed, lumaFraction, chromaFixed, chromaFraction;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (input != planarInput) {
+            Orientation rotation = resolve(input);
+            buildMaps(rotation, input, output, lumaMap1, lumaMap2);
+            buildMaps(rotation, input / 2, output / 2, chromaMap1, chromaMap2);
+            planarInput = input;
+        }
+        lumaFixed = lumaMap1;
+        lumaFraction = lumaMap2;
+        chromaFixed = chromaMap1;
+        chromaFraction = chromaMap2;
+    }
+    cv::Size target = lumaFixed.size();
+    dst.create(target.height * 3 / 2, target.width, CV_8UC1);
+
+    // Planes are views into the contiguous buffers, so each remap writes its plane in place
+    size_t inputLuma = static_cast<size_t>(input.area());
+    size_t outputLuma = static_cast<size_t>(target.area());
+    uchar* in = const_cast<uchar*>(src.ptr());
+    uchar* out = dst.ptr();
+    cv::Size inputChroma = input / 2;
+    cv::Size outputChroma = target / 2;
+    cv::Mat lumaOut(target, CV_8UC1, out);
+    cv::remap(cv::Mat(input, CV_8UC1, in), lumaOut, lumaFixed, lumaFraction,
+              cv::INTER_LINEAR, cv::BORDER_REPLICATE);
+    if (layout == PixelLayout::NV12) {
+        cv::Mat chromaOut(outputChroma, CV_8UC2, out + outputLuma);
+        cv::remap(cv::Mat(inputChroma, CV_8UC2, in + inputLuma), chromaOut, chromaFixed, chromaFraction,
+                  cv::INTER_LINEAR, cv::BORDER_REPLICATE);
+        return;
+    }
+    for (int plane = 0; plane < 2; ++plane) {
+        size_t inputOffset = inputLuma + plane * inputLuma / 4;
+        size_t outputOffset = outputLuma + plane * outputLuma / 4;
+        cv::Mat chromaOut(outputChroma, CV_8UC1, out + outputOffset);
+        cv::remap(cv::Mat(inputChroma, CV_8UC1, in + inputOffset), chromaOut, chromaFixed, chromaFraction,
+                  cv::INTER_LINEAR, cv::BORDER_REPLICATE);
+    }
+}
+
+void FrameOrienter::orient(const cv::Mat& src, cv::Mat& dst) const {
+    Orientation rotation;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        rotation = resolve(src.size());
+    }
+    switch (rotation) {
+        case Orientation::CCW90: cv::rotate(src, dst, cv::ROTATE_90_COUNTERCLOCKWISE); break;
+        case Orientation::CW90: cv::rotate(src, dst, cv::ROTATE_90_CLOCKWISE); break;
+        case Orientation::ROT180: cv::rotate(src, dst, cv::ROTATE_180); break;
+        default: dst = src; break;
+    }
+}
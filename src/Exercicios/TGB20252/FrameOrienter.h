@@ -0,0 +1,56 @@
+#ifndef FRAME_ORIENTER_H
+#define FRAME_ORIENTER_H
+
+#include <opencv2/opencv.hpp>
+#include <mutex>
+#include <string>
+
+#include "FrameSource.h"
+
+enum class Orientation {
+    NONE,
+    CW90,
+    CCW90,
+    ROT180,
+    AUTO    // CCW90 when the input and output disagree on portrait/landscape, NONE otherwise
+};
+
+bool parseOrientation(const std::string& text, Orientation& orientation);
+
+// Turns decoded frames into display frames: rotation and scaling as a single cv::remap through
+// fixed-point maps built once per input size, written into the caller's buffer. Replaces a full
+// resolution rotate into a temporary followed by a resize (two passes, two allocations).
+// Safe to call from several threads; the maps are rebuilt only when the input size changes.
+class FrameOrienter {
+public:
+    explicit FrameOrienter(Orientation orientation = Orientation::CCW90, cv::Size outputSize = cv::Size(540, 960));
+
+    void configure(Orientation orientation, cv::Size outputSize);
+    Orientation orientation() const;
+    cv::Size outputSize() const;
+
+    // dst keeps its buffer when it already has the output size and type
+    void apply(const cv::Mat& src, cv::Mat& dst);
+    // The same warp on a planar 4:2:0 frame, plane by plane, into a planar frame of the output size
+    // (which must be even); chroma goes through its own half-size maps
+    void applyPlanar(const cv::Mat& src, PixelLayout layout, cv::Mat& dst);
+    // Rotation only, at the input resolution (captures)
+    void orient(const cv::Mat& src, cv::Mat& dst) const;
+
+private:
+    mutable std::mutex mutex;
+    Orientation requested;
+    cv::Size output;
+    cv::Size mappedInput;
+    cv::Mat map1;
+    cv::Mat map2;
+    cv::Size planarInput;
+    cv::Mat lumaMap1;
+    cv::Mat lumaMap2;
+    cv::Mat chromaMap1;
+    cv::Mat chromaMap2;
+
+    Orientation resolve(cv::Size input) const;
+};
+
+#endif
@@ -0,0 +1,40 @@
+#include "FramePool.h"
+
+FramePool::FramePool(int maxBuffers) : maxBuffers(maxBuffers) {}
+
+bool FramePool::isShared(const cv::Mat& mat) {
+    return mat.u && mat.u->refcount > 1;
+}
+
+cv::Mat FramePool::acquire(cv::Size size, int type) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& buffer : buffers) {
+        if (!isShared(buffer) && buffer.size() == size && buffer.type() == type) {
+            return buffer;
+        }
+    }
+
+    cv::Mat buffer(size, type);
+    if (static_cast<int>(buffers.size()) < maxBuffers) {
+        buffers.push_back(buffer);
+    } else {
+        // Every pooled buffer is still referenced: replace one of another format or hand out an untracked one
+        for (auto& pooled : buffers) {
+            if (!isShared(pooled)) {
+                pooled = buffer;
+                break;
+            }
+        }
+    }
+    return buffer;
+}
+
+void FramePool::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    buffers.clear();
+}
+
+int FramePool::allocated() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<int>(buffers.size());
+}
@@ -0,0 +1,28 @@
+#ifndef FRAME_POOL_H
+#define FRAME_POOL_H
+
+#include <opencv2/opencv.hpp>
+#include <mutex>
+#include <vector>
+
+// Recycles frame-sized buffers using cv::Mat's own reference count: the pool keeps one header per
+// buffer it handed out, and a buffer is free again once that header is the only one left.
+// A buffer returned by acquire() is never written by anyone else, so frames built in it can be
+// shared by reference (history ring, encoders) as long as their holders only read them.
+class FramePool {
+public:
+    explicit FramePool(int maxBuffers = 16);
+
+    cv::Mat acquire(cv::Size size, int type);
+    void clear();
+    int allocated() const;
+
+    static bool isShared(const cv::Mat& mat);
+
+private:
+    mutable std::mutex mutex;
+    std::vector<cv::Mat> buffers;
+    int maxBuffers;
+};
+
+#endif
@@ -0,0 +1,563 @@
+#include "FrameSink.h"
+#include "OptionParsing.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <new>
+#include <vector>
+
+#ifndef _WIN32
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#else
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace {
+const int kPollMs = 100;
+const uint32_t kRingHeaderBytes = 4096;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "the ring counters are shared across processes");
+static_assert(sizeof(SinkRingHeader) <= kRingHeaderBytes, "ring header must fit before the first slot");
+
+struct Chunk {
+    const void* data;
+    size_t size;
+};
+
+void rateFraction(double fps, uint32_t& num, uint32_t& den) {
+    if (std::fabs(fps - std::round(fps)) < 1e-3) {
+        num = static_cast<uint32_t>(std::round(fps));
+        den = 1;
+    } else {
+        num = static_cast<uint32_t>(std::round(fps * 1000.0));
+        den = 1000;
+    }
+}
+
+void sleepMs(int milliseconds) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+}
+
+// The reader side of the sink: a byte stream (stdout, pipe or file) or the shared-memory ring
+class SinkOutput {
+public:
+    ~SinkOutput() { close(); }
+
+    // Named pipes wait here, polling abort, until a reader opens the other end
+    bool open(const SinkOptions& options, int stdoutFd, cv::Size size, double fps, const std::atomic<bool>& abort) {
+        uint32_t num;
+        uint32_t den;
+        rateFraction(fps, num, den);
+        bool i420 = options.format == SinkFormat::Y4M;
+        frameBytes = static_cast<size_t>(size.width) * size.height * (i420 ? 3 : 6) / 2;
+
+        if (options.target.rfind("shm:", 0) == 0) {
+            return openRing(options, size, num, den, i420);
+        }
+        if (!openStream(options.target, stdoutFd, abort)) {
+            return false;
+        }
+        framed = i420;
+        if (framed) {
+            std::string header = "YUV4MPEG2 W" + std::to_string(size.width) + " H" + std::to_string(size.height) +
+                                 " F" + std::to_string(num) + ":" + std::to_string(den) + " Ip A1:1 C420jpeg\n";
+            Chunk chunk{header.data(), header.size()};
+            return writeAll(&chunk, 1, abort);
+        }
+        return true;
+    }
+
+    // pixels is continuous and frameBytes long
+    bool write(const cv::Mat& pixels, int repeat, const std::atomic<bool>& abort) {
+#ifndef _WIN32
+        if (ring) {
+            for (int i = 0; i < repeat; ++i) {
+                if (!writeSlot(pixels.data, abort)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+#endif
+        static const char kFrameTag[] = "FRAME\n";
+        for (int i = 0; i < repeat; ++i) {
+            Chunk chunks[2] = {{kFrameTag, sizeof(kFrameTag) - 1}, {pixels.data, frameBytes}};
+            if (!(framed ? writeAll(chunks, 2, abort) : writeAll(chunks + 1, 1, abort))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // A reader that went away from a named pipe can be replaced by a new one
+    bool reconnectable() const { return fifo; }
+
+    void close() {
+#ifndef _WIN32
+        if (ring) {
+            ring->closed.store(1, std::memory_order_release);
+            munmap(ring, ringBytes);
+            shm_unlink(ringName.c_str());
+            ring = nullptr;
+        }
+#endif
+        if (fd >= 0 && ownsFd) {
+#ifndef _WIN32
+            ::close(fd);
+#else
+            _close(fd);
+#endif
+        }
+        fd = -1;
+    }
+
+private:
+    int fd{-1};
+    bool ownsFd{true};
+    bool fifo{false};
+    bool framed{false};
+    size_t frameBytes{0};
+#ifndef _WIN32
+    SinkRingHeader* ring{nullptr};
+    size_t ringBytes{0};
+    std::string ringName;
+#endif
+
+    bool openStream(const std::string& target, int stdoutFd, const std::atomic<bool>& abort) {
+#ifndef _WIN32
+        if (target == "-") {
+            fd = stdoutFd;
+            ownsFd = false;
+        } else {
+            struct stat info;
+            if (stat(target.c_str(), &info) != 0) {
+                if (mkfifo(target.c_str(), 0644) != 0) {
+                    std::cerr << "Sink: could not create pipe " << target << ": " << std::strerror(errno) << std::endl;
+                    return false;
+                }
+                fifo = true;
+            } else {
+                fifo = S_ISFIFO(info.st_mode);
+            }
+            if (fifo) {
+                std::cout << "Sink: waiting for a reader on " << target << std::endl;
+                // A non-blocking open fails with ENXIO until the other end is opened for reading
+                while ((fd = ::open(target.c_str(), O_WRONLY | O_NONBLOCK)) < 0) {
+                    if (errno != ENXIO || abort) {
+                        return false;
+                    }
+                    sleepMs(kPollMs);
+                }
+            } else {
+                fd = ::open(target.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_NONBLOCK, 0644);
+            }
+            ownsFd = true;
+        }
+        if (fd < 0) {
+            std::cerr << "Sink: could not open " << target << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        // Writes wait in poll() instead, so stop() is noticed while the reader is stalled. A terminal
+        // shares its file description with stderr, so it stays blocking.
+        if (!isatty(fd)) {
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        }
+        return true;
+#else
+        (void)abort;
+        if (target == "-") {
+            fd = stdoutFd;
+            ownsFd = false;
+            _setmode(fd, _O_BINARY);
+        } else {
+            fd = _open(target.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, 0644);
+            ownsFd = true;
+        }
+        if (fd < 0) {
+            std::cerr << "Sink: could not open " << target << std::endl;
+            return false;
+        }
+        return true;
+#endif
+    }
+
+    bool writeAll(Chunk* chunks, int count, const std::atomic<bool>& abort) {
+#ifndef _WIN32
+        std::vector<struct iovec> pending(count);
+        for (int i = 0; i < count; ++i) {
+            pending[i].iov_base = const_cast<void*>(chunks[i].data);
+            pending[i].iov_len = chunks[i].size;
+        }
+        struct iovec* next = pending.data();
+        int left = count;
+        while (left > 0) {
+            ssize_t sent = writev(fd, next, left);
+            if (sent < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    if (errno != EPIPE) {
+                        std::cerr << "Sink: write failed: " << std::strerror(errno) << std::endl;
+                    }
+                    return false;
+                }
+                // The reader is behind: wait for room, giving up only when the sink is stopped
+                struct pollfd wait{fd, POLLOUT, 0};
+                while (poll(&wait, 1, kPollMs) == 0) {
+                    if (abort) {
+                        return false;
+                    }
+                }
+                continue;
+            }
+            while (left > 0 && static_cast<size_t>(sent) >= next->iov_len) {
+                sent -= static_cast<ssize_t>(next->iov_len);
+                ++next;
+                --left;
+            }
+            if (left > 0) {
+                next->iov_base = static_cast<char*>(next->iov_base) + sent;
+                next->iov_len -= static_cast<size_t>(sent);
+            }
+        }
+        return true;
+#else
+        (void)abort;
+        for (int i = 0; i < count; ++i) {
+            const char* data = static_cast<const char*>(chunks[i].data);
+            size_t left = chunks[i].size;
+            while (left > 0) {
+                int sent = _write(fd, data, static_cast<unsigned>(std::min<size_t>(left, 1 << 30)));
+                if (sent <= 0) {
+                    return false;
+                }
+                data += sent;
+                left -= static_cast<size_t>(sent);
+            }
+        }
+        return true;
+#endif
+    }
+
+    bool openRing(const SinkOptions& options, cv::Size size, uint32_t num, uint32_t den, bool i420) {
+#ifndef _WIN32
+        ringName = options.target.substr(4);
+        if (ringName.empty() || ringName[0] != '/') {
+            ringName = "/" + ringName;
+        }
+        int slots = std::max(2, options.ringSlots);
+        ringBytes = kRingHeaderBytes + static_cast<size_t>(slots) * frameBytes;
+        int shm = shm_open(ringName.c_str(), O_CREAT | O_RDWR, 0600);
+        if (shm < 0 || ftruncate(shm, static_cast<off_t>(ringBytes)) != 0) {
+            std::cerr << "Sink: could not create shared memory " << ringName << ": " << std::strerror(errno) << std::endl;
+            if (shm >= 0) {
+                ::close(shm);
+            }
+            return false;
+        }
+        void* mapping = mmap(nullptr, ringBytes, PROT_READ | PROT_WRITE, MAP_SHARED, shm, 0);
+        ::close(shm);
+        if (mapping == MAP_FAILED) {
+            std::cerr << "Sink: could not map " << ringName << std::endl;
+            return false;
+        }
+
+        ring = new (mapping) SinkRingHeader();
+        ring->version = 1;
+        ring->format = i420 ? 1 : 0;
+        ring->width = static_cast<uint32_t>(size.width);
+        ring->height = static_cast<uint32_t>(size.height);
+        ring->fpsNum = num;
+        ring->fpsDen = den;
+        ring->slotCount = static_cast<uint32_t>(slots);
+        ring->headerBytes = kRingHeaderBytes;
+        ring->slotBytes = frameBytes;
+        ring->written.store(0);
+        ring->consumed.store(0);
+        ring->closed.store(0);
+        // Readers check the magic last, so they never see a half-initialised header
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(ring->magic, "VIASINK", 8);
+        std::cout << "Sink: shared-memory ring " << ringName << " (" << slots << " slots of " << frameBytes << " bytes)" << std::endl;
+        return true;
+#else
+        (void)options; (void)size; (void)num; (void)den; (void)i420;
+        std::cerr << "Sink: shared-memory rings are not supported on this platform" << std::endl;
+        return false;
+#endif
+    }
+
+#ifndef _WIN32
+    bool writeSlot(const void* pixels, const std::atomic<bool>& abort) {
+        uint64_t sequence = ring->written.load(std::memory_order_relaxed);
+        // Every slot still unread: wait for the reader rather than overwrite a frame it may be copying
+        while (sequence - ring->consumed.load(std::memory_order_acquire) >= ring->slotCount) {
+            if (abort) {
+                return false;
+            }
+            sleepMs(1);
+        }
+        uchar* slot = reinterpret_cast<uchar*>(ring) + kRingHeaderBytes + (sequence % ring->slotCount) * frameBytes;
+        std::memcpy(slot, pixels, frameBytes);
+        ring->written.store(sequence + 1, std::memory_order_release);
+        return true;
+    }
+#endif
+};
+}
+
+bool parseSinkOptions(const std::string& text, SinkOptions& options) {
+    size_t colon = text.find(':');
+    if (colon == std::string::npos || colon + 1 >= text.size()) {
+        return false;
+    }
+    std::string format = text.substr(0, colon);
+    if (format == "y4m") {
+        options.format = SinkFormat::Y4M;
+    } else if (format == "raw") {
+        options.format = SinkFormat::RAW;
+    } else {
+        return false;
+    }
+    options.target = text.substr(colon + 1);
+
+    // shm:<name>[:slots]
+    if (options.target.rfind("shm:", 0) == 0) {
+        size_t slots = options.target.find(':', 4);
+        if (slots != std::string::npos) {
+            if (!parseNumberOption(options.target.substr(slots + 1), 2, std::numeric_limits<int>::max(), options.ringSlots)) {
+                return false;
+            }
+            options.target = options.target.substr(0, slots);
+        }
+        return options.target.size() > 4;
+    }
+    return true;
+}
+
+FrameSink::FrameSink(int maxQueued) : maxQueued(std::max(1, maxQueued)) {}
+
+FrameSink::~FrameSink() {
+    stop();
+#ifndef _WIN32
+    if (stdoutFd >= 0) {
+        ::close(stdoutFd);
+    }
+#endif
+}
+
+bool FrameSink::configure(const SinkOptions& sinkOptions) {
+    std::lock_guard<std::mutex> lock(mutex);
+    options = sinkOptions;
+    if (options.target == "-" && stdoutFd < 0) {
+        std::cout.flush();
+#ifndef _WIN32
+        stdoutFd = dup(STDOUT_FILENO);
+        if (stdoutFd < 0 || dup2(STDERR_FILENO, STDOUT_FILENO) < 0) {
+            std::cerr << "Sink: could not take over stdout" << std::endl;
+            return false;
+        }
+#else
+        stdoutFd = _dup(1);
+        if (stdoutFd < 0 || _dup2(2, 1) < 0) {
+            std::cerr << "Sink: could not take over stdout" << std::endl;
+            return false;
+        }
+#endif
+    }
+#ifndef _WIN32
+    // A reader that exits must turn into EPIPE on the sink thread, not kill the whole process
+    std::signal(SIGPIPE, SIG_IGN);
+#endif
+    configured = true;
+    return true;
+}
+
+void FrameSink::setPolicy(RecordPolicy value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    policy = value;
+}
+
+bool FrameSink::start(double fps, cv::Size size, double timestamp) {
+    stop();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!configured || size.empty()) {
+        return false;
+    }
+    frameSize = size;
+    if (options.format == SinkFormat::Y4M) {
+        // 4:2:0 chroma needs even dimensions
+        frameSize = cv::Size(size.width & ~1, size.height & ~1);
+    }
+    pacer.reset(fps > 1.0 ? fps : 30.0, timestamp);
+    jobs.clear();
+    framesWritten = 0;
+    running = true;
+    connected = false;
+    failed = false;
+    abort = false;
+    worker = std::thread(&FrameSink::workerLoop, this);
+    return true;
+}
+
+void FrameSink::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+        abort = true;
+        jobs.clear();
+    }
+    wake.notify_one();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+bool FrameSink::isConfigured() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return configured;
+}
+
+bool FrameSink::isActive() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return running && !failed;
+}
+
+bool FrameSink::isConnected() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return connected;
+}
+
+void FrameSink::submit(const cv::Mat& frame, double timestamp) {
+    if (frame.empty()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!running || !connected) {
+        return;
+    }
+    if (!paced) {
+        // Slots count from the moment a reader is attached, not from start()
+        pacer.reset(pacer.fps(), timestamp);
+        paced = true;
+    }
+    int repeat = pacer.admit(timestamp, static_cast<int>(jobs.size()) >= maxQueued, policy);
+    if (repeat == 0) {
+        return;
+    }
+    jobs.push_back({frame, repeat});
+    wake.notify_one();
+}
+
+int64_t FrameSink::written() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return framesWritten;
+}
+
+int64_t FrameSink::duplicated() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pacer.duplicated();
+}
+
+int64_t FrameSink::dropped() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pacer.dropped();
+}
+
+std::string FrameSink::describe() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string target = options.target == "-" ? "stdout" : options.target;
+    return (options.format == SinkFormat::Y4M ? "y4m -> " : "raw -> ") + target;
+}
+
+// The pixels actually sent: the published frame itself when it already has the sink's layout,
+// otherwise one conversion into a recycled buffer
+cv::Mat FrameSink::convert(const cv::Mat& frame) {
+    cv::Mat bgr = frame;
+    if (bgr.channels() == 1) {
+        cv::Mat converted = conversionPool.acquire(bgr.size(), CV_8UC3);
+        cv::cvtColor(bgr, converted, cv::COLOR_GRAY2BGR);
+        bgr = converted;
+    }
+    if (bgr.size() != frameSize) {
+        cv::Mat resized = conversionPool.acquire(frameSize, CV_8UC3);
+        cv::resize(bgr, resized, frameSize, 0, 0, cv::INTER_AREA);
+        bgr = resized;
+    }
+    if (options.format == SinkFormat::RAW) {
+        return bgr.isContinuous() ? bgr : bgr.clone();
+    }
+    cv::Mat i420 = conversionPool.acquire(cv::Size(frameSize.width, frameSize.height * 3 / 2), CV_8UC1);
+    cv::cvtColor(bgr, i420, cv::COLOR_BGR2YUV_I420);
+    return i420;
+}
+
+void FrameSink::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    SinkOptions target = options;
+    cv::Size size = frameSize;
+    double fps = pacer.fps();
+    int fd = stdoutFd;
+    lock.unlock();
+
+    SinkOutput output;
+    while (!abort) {
+        if (!output.open(target, fd, size, fps, abort)) {
+            break;
+        }
+        lock.lock();
+        connected = true;
+        paced = false;
+        lock.unlock();
+        std::cout << "Sink: streaming " << size.width << "x" << size.height << " at " << fps << " fps to "
+                  << (target.target == "-" ? "stdout" : target.target) << std::endl;
+
+        bool ok = true;
+        lock.lock();
+        while (ok) {
+            wake.wait(lock, [this] { return !running || !jobs.empty(); });
+            if (!running) {
+                break;
+            }
+            Job job = std::move(jobs.front());
+            jobs.pop_front();
+            lock.unlock();
+
+            cv::Mat pixels = convert(job.frame);
+            job.frame.release();
+            ok = output.write(pixels, job.repeat, abort);
+
+            lock.lock();
+            if (ok) {
+                framesWritten += job.repeat;
+            }
+        }
+        connected = false;
+        jobs.clear();
+        lock.unlock();
+
+        output.close();
+        if (ok || abort || !output.reconnectable()) {
+            break;
+        }
+        std::cout << "Sink: reader closed the pipe, waiting for a new one" << std::endl;
+    }
+
+    lock.lock();
+    if (running) {
+        failed = true;
+        std::cerr << "Sink stopped: " << framesWritten << " frames written" << std::endl;
+    }
+}
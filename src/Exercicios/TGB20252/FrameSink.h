@@ -0,0 +1,112 @@
+#ifndef FRAME_SINK_H
+#define FRAME_SINK_H
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "FramePool.h"
+#include "VideoRecorder.h"
+
+enum class SinkFormat {
+    Y4M,  // I420; framed as YUV4MPEG2 on streams, bare planes in a ring slot
+    RAW   // packed BGR24, written straight from the frame buffer
+};
+
+// Where the stream goes: "-" is stdout, "shm:<name>[:slots]" a shared-memory ring, anything else a
+// path (created as a named pipe when it does not exist)
+struct SinkOptions {
+    SinkFormat format{SinkFormat::Y4M};
+    std::string target;
+    int ringSlots{4};
+};
+
+// "y4m:<target>" or "raw:<target>"
+bool parseSinkOptions(const std::string& text, SinkOptions& options);
+
+// Layout of the shared-memory ring, at offset 0 of the segment. Slot i starts at
+// headerBytes + i * slotBytes. The writer fills slot written % slotCount and then increments
+// written; a reader copies slot consumed % slotCount and then increments consumed. The writer
+// never overwrites an unread slot, so a reader that stops attaching stalls the stream.
+struct SinkRingHeader {
+    char magic[8];         // "VIASINK"
+    uint32_t version;
+    uint32_t format;       // 0 = BGR24, 1 = I420
+    uint32_t width;
+    uint32_t height;
+    uint32_t fpsNum;
+    uint32_t fpsDen;
+    uint32_t slotCount;
+    uint32_t headerBytes;
+    uint64_t slotBytes;
+    std::atomic<uint64_t> written;
+    std::atomic<uint64_t> consumed;
+    std::atomic<uint32_t> closed;  // set by the writer on stop
+};
+
+// Streams processed frames out of the process for an external encoder (ffmpeg and the like)
+// without encoding anything here. Pacing is the recorder's: one frame per slot at the source FPS,
+// with RecordPolicy deciding what fills slots no frame arrived for. Backpressure stops at the
+// bounded queue: a slow reader blocks only the sink thread, and once the queue is full new frames
+// are dropped and counted instead of stalling the render loop.
+class FrameSink {
+public:
+    explicit FrameSink(int maxQueued = 4);
+    ~FrameSink();
+
+    // Claims the output right away; for stdout this moves fd 1 over to stderr so log lines can no
+    // longer end up inside the stream. Call before anything else is printed.
+    bool configure(const SinkOptions& options);
+    void setPolicy(RecordPolicy policy);
+    // The reader (pipe or ring) is attached on the sink thread, so this never waits for it
+    bool start(double fps, cv::Size size, double timestamp);
+    // Abandons queued frames; a write in progress finishes or times out first
+    void stop();
+
+    bool isConfigured() const;
+    bool isActive() const;
+    bool isConnected() const;
+    // frame must not be written afterwards; timestamp in seconds on the same clock as start()
+    void submit(const cv::Mat& frame, double timestamp);
+
+    int64_t written() const;
+    int64_t duplicated() const;
+    int64_t dropped() const;
+    std::string describe() const;
+
+private:
+    struct Job {
+        cv::Mat frame;
+        int repeat{1};
+    };
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::thread worker;
+    std::deque<Job> jobs;
+    FramePool conversionPool{4};
+    RecordPolicy policy{RecordPolicy::DUPLICATE};
+    SlotPacer pacer;
+    int maxQueued;
+
+    SinkOptions options;
+    bool configured{false};
+    bool running{false};
+    bool connected{false};
+    bool paced{false};
+    bool failed{false};
+    std::atomic<bool> abort{false};
+    int stdoutFd{-1};
+    cv::Size frameSize;
+    int64_t framesWritten{0};
+
+    void workerLoop();
+    cv::Mat convert(const cv::Mat& frame);
+};
+
+#endif
@@ -0,0 +1,629 @@
+#include "FrameSource.h"
+#include "FramePool.h"
+#include <opencv2/core/utils/filesystem.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+double sanitizeFps(double fps) {
+    return (fps <= 0.0 || fps > 120.0) ? 30.0 : fps;
+}
+
+bool parseSize(const std::string& text, cv::Size& size) {
+    size_t x = text.find('x');
+    if (x == std::string::npos) {
+        return false;
+    }
+    size = cv::Size(std::atoi(text.c_str()), std::atoi(text.c_str() + x + 1));
+    return size.width > 0 && size.height > 0;
+}
+
+bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Read-only view of a whole file. POSIX maps it so frames are read straight from the page cache;
+// elsewhere the file is read into memory once
+class MappedFile {
+public:
+    ~MappedFile() {
+#ifndef _WIN32
+        if (mapping) {
+            munmap(mapping, length);
+        }
+#endif
+    }
+
+    bool open(const std::string& path) {
+#ifndef _WIN32
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+            ::close(fd);
+            return false;
+        }
+        length = static_cast<size_t>(info.st_size);
+        void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (address == MAP_FAILED) {
+            return false;
+        }
+        mapping = address;
+        madvise(mapping, length, MADV_SEQUENTIAL);
+        return true;
+#else
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            return false;
+        }
+        buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return !buffer.empty();
+#endif
+    }
+
+    const uchar* data() const {
+#ifndef _WIN32
+        return static_cast<const uchar*>(mapping);
+#else
+        return buffer.data();
+#endif
+    }
+
+    size_t size() const {
+#ifndef _WIN32
+        return length;
+#else
+        return buffer.size();
+#endif
+    }
+
+private:
+#ifndef _WIN32
+    void* mapping{nullptr};
+    size_t length{0};
+#else
+    std::vector<uchar> buffer;
+#endif
+};
+
+class VideoFileSource : public FrameSource {
+public:
+    bool open(const std::string& path) {
+        this->path = path;
+        capture.open(path);
+        if (!capture.isOpened()) {
+            return false;
+        }
+        rate = sanitizeFps(capture.get(cv::CAP_PROP_FPS));
+        indexKeyframes();
+        if (count <= 0) {
+            // Container estimate; corrected by read() if the stream turns out shorter
+            double estimate = capture.get(cv::CAP_PROP_FRAME_COUNT);
+            count = estimate > 0.0 ? static_cast<int64_t>(estimate) : -1;
+        }
+        return true;
+    }
+
+    bool read(cv::Mat& frame) override {
+        capture >> frame;
+        if (frame.empty()) {
+            if (next > 0) {
+                count = next;
+            }
+            capture.set(cv::CAP_PROP_POS_FRAMES, 0);
+            next = 0;
+            capture >> frame;
+        }
+        if (frame.empty()) {
+            return false;
+        }
+        ++next;
+        return true;
+    }
+
+    bool rewind() override {
+        return seek(0);
+    }
+
+    double fps() const override { return rate; }
+    std::string name() const override { return "video:" + path; }
+
+    int64_t frameCount() const override { return count; }
+    int64_t position() const override { return next; }
+
+    bool seek(int64_t index) override {
+        if (!capture.set(cv::CAP_PROP_POS_FRAMES, static_cast<double>(index))) {
+            return false;
+        }
+        next = index;
+        return true;
+    }
+
+    int64_t keyframeBefore(int64_t index) const override {
+        if (keyframes.empty()) {
+            return index;
+        }
+        auto after = std::upper_bound(keyframes.begin(), keyframes.end(), index);
+        return after == keyframes.begin() ? 0 : *(after - 1);
+    }
+
+private:
+    cv::VideoCapture capture;
+    std::string path;
+    double rate{30.0};
+    int64_t count{-1};
+    int64_t next{0};
+    std::vector<int64_t> keyframes;
+
+    // Demuxes the whole file once without decoding (FFmpeg raw mode) to learn the exact frame count
+    // and where every keyframe is; without it seeks still work, only without GOP alignment
+    void indexKeyframes() {
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 6)
+        try {
+            cv::VideoCapture demuxer;
+            if (!demuxer.open(path, cv::CAP_FFMPEG, {cv::CAP_PROP_FORMAT, -1})) {
+                return;
+            }
+            cv::Mat packet;
+            int64_t packets = 0;
+            while (demuxer.read(packet)) {
+                if (demuxer.get(cv::CAP_PROP_LRF_HAS_KEY_FRAME) != 0.0) {
+                    keyframes.push_back(packets);
+                }
+                ++packets;
+            }
+            if (packets > 0) {
+                count = packets;
+            }
+        } catch (const cv::Exception& e) {
+            std::cerr << "Keyframe index unavailable for " << path << ": " << e.what() << std::endl;
+            keyframes.clear();
+        }
+#endif
+    }
+};
+
+class ImageSequenceSource : public FrameSource {
+public:
+    bool open(const std::string& directory, double fps) {
+        this->directory = directory;
+        rate = sanitizeFps(fps);
+        std::vector<cv::String> found;
+        cv::glob(directory + "/*", found, false);
+        for (const auto& path : found) {
+            std::string lower = path;
+            std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+            if (endsWith(lower, ".png") || endsWith(lower, ".jpg") || endsWith(lower, ".jpeg") ||
+                endsWith(lower, ".bmp") || endsWith(lower, ".webp")) {
+                files.push_back(path);
+            }
+        }
+        std::sort(files.begin(), files.end());
+        return !files.empty();
+    }
+
+    bool read(cv::Mat& frame) override {
+        for (size_t attempt = 0; attempt < files.size(); ++attempt) {
+            frame = cv::imread(files[next], cv::IMREAD_COLOR);
+            next = (next + 1) % files.size();
+            if (!frame.empty()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool rewind() override {
+        next = 0;
+        return true;
+    }
+
+    double fps() const override { return rate; }
+    std::string name() const override { return "images:" + directory; }
+
+    int64_t frameCount() const override { return static_cast<int64_t>(files.size()); }
+    int64_t position() const override { return static_cast<int64_t>(next); }
+
+    bool seek(int64_t index) override {
+        if (index < 0 || index >= frameCount()) {
+            return false;
+        }
+        next = static_cast<size_t>(index);
+        return true;
+    }
+
+private:
+    std::string directory;
+    std::vector<std::string> files;
+    size_t next{0};
+    double rate{30.0};
+};
+
+// Raw frames and Y4M share the mapping and the per-frame offsets; only the pixel layout differs.
+// 4:2:0 frames are handed out as planes; the other layouts are converted to BGR here
+class MappedSource : public FrameSource {
+public:
+    enum class Packing { BGR, I420, NV12, YUV444, MONO };
+
+    bool openRaw(const std::string& path, cv::Size size, Packing format, double fps) {
+        this->path = path;
+        label = "raw:";
+        frameSize = size;
+        packing = format;
+        rate = sanitizeFps(fps);
+        if (packing != Packing::BGR && (size.width % 2 || size.height % 2)) {
+            std::cerr << "4:2:0 raw frames need an even width and height" << std::endl;
+            return false;
+        }
+        if (!file.open(path)) {
+            return false;
+        }
+        size_t bytes = frameBytes();
+        for (size_t offset = 0; offset + bytes <= file.size(); offset += bytes) {
+            offsets.push_back(offset);
+        }
+        return !offsets.empty();
+    }
+
+    bool openY4m(const std::string& path) {
+        this->path = path;
+        label = "y4m:";
+        if (!file.open(path)) {
+            return false;
+        }
+        const char* data = reinterpret_cast<const char*>(file.data());
+        const char* end = data + file.size();
+        const char* lineEnd = static_cast<const char*>(std::memchr(data, '\n', file.size()));
+        if (!lineEnd || std::strncmp(data, "YUV4MPEG2", 9) != 0) {
+            std::cerr << path << " is not a YUV4MPEG2 file" << std::endl;
+            return false;
+        }
+
+        std::istringstream header(std::string(data + 9, lineEnd));
+        std::string token;
+        std::string colorspace = "420jpeg";
+        while (header >> token) {
+            switch (token[0]) {
+                case 'W': frameSize.width = std::atoi(token.c_str() + 1); break;
+                case 'H': frameSize.height = std::atoi(token.c_str() + 1); break;
+                case 'C': colorspace = token.substr(1); break;
+                case 'F': {
+                    double num = std::atof(token.c_str() + 1);
+                    size_t colon = token.find(':');
+                    double den = colon == std::string::npos ? 1.0 : std::atof(token.c_str() + colon + 1);
+                    rate = sanitizeFps(den > 0.0 ? num / den : 0.0);
+                    break;
+                }
+                default: break;
+            }
+        }
+        if (colorspace.rfind("420", 0) == 0) {
+            packing = Packing::I420;
+        } else if (colorspace.rfind("444", 0) == 0 && colorspace.find("alpha") == std::string::npos) {
+            packing = Packing::YUV444;
+        } else if (colorspace.rfind("mono", 0) == 0) {
+            packing = Packing::MONO;
+        } else {
+            std::cerr << "Unsupported Y4M colorspace C" << colorspace << std::endl;
+            return false;
+        }
+        if (frameSize.width <= 0 || frameSize.height <= 0 ||
+            (packing == Packing::I420 && (frameSize.width % 2 || frameSize.height % 2))) {
+            std::cerr << "Invalid Y4M frame size in " << path << std::endl;
+            return false;
+        }
+
+        // Each frame is "FRAME[ params]\n" followed by the planes
+        size_t bytes = frameBytes();
+        const char* cursor = lineEnd + 1;
+        while (cursor + 5 < end && std::strncmp(cursor, "FRAME", 5) == 0) {
+            const char* frameHeaderEnd = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+            if (!frameHeaderEnd || static_cast<size_t>(end - frameHeaderEnd - 1) < bytes) {
+                break;
+            }
+            offsets.push_back(static_cast<size_t>(frameHeaderEnd + 1 - data));
+            cursor = frameHeaderEnd + 1 + bytes;
+        }
+        return !offsets.empty();
+    }
+
+    bool read(cv::Mat& frame) override {
+        if (offsets.empty()) {
+            return false;
+        }
+        // The planes are wrapped in place; only the 4:4:4 and mono conversions write new pixels
+        uchar* pixels = const_cast<uchar*>(file.data()) + offsets[next];
+        next = (next + 1) % offsets.size();
+        int w = frameSize.width;
+        int h = frameSize.height;
+        switch (packing) {
+            case Packing::BGR:
+                frame = cv::Mat(h, w, CV_8UC3, pixels);
+                break;
+            case Packing::I420:
+            case Packing::NV12:
+                frame = cv::Mat(h * 3 / 2, w, CV_8UC1, pixels);
+                break;
+            case Packing::YUV444: {
+                // Planes are Y, Cb, Cr; OpenCV's interleaved order is Y, Cr, Cb
+                cv::Mat planes[3] = {
+                    cv::Mat(h, w, CV_8UC1, pixels),
+                    cv::Mat(h, w, CV_8UC1, pixels + 2 * w * h),
+                    cv::Mat(h, w, CV_8UC1, pixels + w * h)
+                };
+                cv::Mat interleaved = scratch.acquire(frameSize, CV_8UC3);
+                cv::merge(planes, 3, interleaved);
+                cv::Mat output = pool.acquire(frameSize, CV_8UC3);
+                cv::cvtColor(interleaved, output, cv::COLOR_YCrCb2BGR);
+                frame = output;
+                break;
+            }
+            case Packing::MONO: {
+                cv::Mat output = pool.acquire(frameSize, CV_8UC3);
+                cv::cvtColor(cv::Mat(h, w, CV_8UC1, pixels), output, cv::COLOR_GRAY2BGR);
+                frame = output;
+                break;
+            }
+        }
+        return true;
+    }
+
+    bool rewind() override {
+        next = 0;
+        return true;
+    }
+
+    double fps() const override { return rate; }
+    std::string name() const override { return label + path; }
+
+    PixelLayout layout() const override {
+        switch (packing) {
+            case Packing::I420: return PixelLayout::I420;
+            case Packing::NV12: return PixelLayout::NV12;
+            default: return PixelLayout::BGR;
+        }
+    }
+
+    int64_t frameCount() const override { return static_cast<int64_t>(offsets.size()); }
+    int64_t position() const override { return static_cast<int64_t>(next); }
+
+    bool seek(int64_t index) override {
+        if (index < 0 || index >= frameCount()) {
+            return false;
+        }
+        next = static_cast<size_t>(index);
+        return true;
+    }
+
+private:
+    MappedFile file;
+    std::string path;
+    std::string label;
+    cv::Size frameSize;
+    Packing packing{Packing::BGR};
+    std::vector<size_t> offsets;
+    size_t next{0};
+    double rate{30.0};
+    FramePool pool{4};
+    FramePool scratch{1};
+
+    size_t frameBytes() const {
+        size_t plane = static_cast<size_t>(frameSize.width) * frameSize.height;
+        switch (packing) {
+            case Packing::I420:
+            case Packing::NV12: return plane * 3 / 2;
+            case Packing::MONO: return plane;
+            default: return plane * 3;
+        }
+    }
+};
+
+class V4l2Source : public FrameSource {
+public:
+    bool open(const std::string& device) {
+        this->device = device;
+#ifdef __linux__
+        const int api = cv::CAP_V4L2;
+#else
+        const int api = cv::CAP_ANY;
+#endif
+        bool numeric = !device.empty() && std::all_of(device.begin(), device.end(), ::isdigit);
+        if (numeric) {
+            capture.open(std::atoi(device.c_str()), api);
+        } else {
+            capture.open(device, api);
+        }
+        if (!capture.isOpened()) {
+            return false;
+        }
+        // Keep only the newest frame queued so the preview does not lag behind the sensor
+        capture.set(cv::CAP_PROP_BUFFERSIZE, 1);
+        rate = sanitizeFps(capture.get(cv::CAP_PROP_FPS));
+        return true;
+    }
+
+    bool read(cv::Mat& frame) override {
+        return capture.read(frame) && !frame.empty();
+    }
+
+    bool rewind() override { return false; }
+    double fps() const override { return rate; }
+    std::string name() const override { return "v4l2:" + device; }
+
+private:
+    cv::VideoCapture capture;
+    std::string device;
+    double rate{30.0};
+};
+
+// Moving gradient, bars and shapes computed from the frame index alone, so every run and every
+// machine sees exactly the same pixels
+class SyntheticSource : public FrameSource {
+public:
+    SyntheticSource(cv::Size size, double fps) : frameSize(size), rate(sanitizeFps(fps)) {}
+
+    bool read(cv::Mat& frame) override {
+        int w = frameSize.width;
+        int h = frameSize.height;
+        int t = static_cast<int>(index);
+        cv::Mat output = pool.acquire(frameSize, CV_8UC3);
+        for (int y = 0; y < h; ++y) {
+            cv::Vec3b* row = output.ptr<cv::Vec3b>(y);
+            for (int x = 0; x < w; ++x) {
+                row[x] = cv::Vec3b(static_cast<uchar>((x * 255 / w + t * 2) & 0xFF),
+                                   static_cast<uchar>(y * 255 / h),
+                                   static_cast<uchar>(((x + t * 4) ^ y) & 0xFF));
+            }
+        }
+
+        static const cv::Scalar kBars[] = {
+            {255, 255, 255}, {0, 255, 255}, {255, 255, 0}, {0, 255, 0},
+            {255, 0, 255}, {0, 0, 255}, {255, 0, 0}, {0, 0, 0}
+        };
+        int barWidth = std::max(1, w / 8);
+        for (int i = 0; i < 8; ++i) {
+            cv::rectangle(output, cv::Rect(i * barWidth, 0, barWidth, h / 8), kBars[i], cv::FILLED);
+        }
+
+        int period = std::max(1, 2 * (w - h / 4));
+        int phase = (t * 6) % period;
+        int cx = h / 8 + (phase < period / 2 ? phase : period - phase);
+        cv::circle(output, cv::Point(cx, h / 2), h / 8, cv::Scalar(40, 160, 220), cv::FILLED, cv::LINE_AA);
+        cv::rectangle(output, cv::Rect(w / 2 - h / 10, h - h / 4, h / 5, h / 8), cv::Scalar(220, 220, 220), cv::FILLED);
+        cv::putText(output, std::to_string(index), cv::Point(w / 2 - h / 12, h - h / 8 - h / 40),
+                    cv::FONT_HERSHEY_SIMPLEX, h / 400.0, cv::Scalar(20, 20, 20), 2);
+
+        ++index;
+        frame = output;
+        return true;
+    }
+
+    bool rewind() override {
+        index = 0;
+        return true;
+    }
+
+    double fps() const override { return rate; }
+    std::string name() const override {
+        return "synthetic:" + std::to_string(frameSize.width) + "x" + std::to_string(frameSize.height);
+    }
+
+private:
+    cv::Size frameSize;
+    double rate;
+    uint64_t index{0};
+    FramePool pool{4};
+};
+}
+
+void convertToBgr(const cv::Mat& frame, PixelLayout layout, cv::Mat& bgr) {
+    switch (layout) {
+        case PixelLayout::I420: cv::cvtColor(frame, bgr, cv::COLOR_YUV2BGR_I420); break;
+        case PixelLayout::NV12: cv::cvtColor(frame, bgr, cv::COLOR_YUV2BGR_NV12); break;
+        default: bgr = frame; break;
+    }
+}
+
+std::unique_ptr<FrameSource> openFrameSource(const std::string& spec) {
+    std::string body = spec;
+    double fps = 0.0;
+    size_t at = body.rfind('@');
+    if (at != std::string::npos && at + 1 < body.size() &&
+        body.find_first_not_of("0123456789.", at + 1) == std::string::npos) {
+        fps = std::atof(body.c_str() + at + 1);
+        body = body.substr(0, at);
+    }
+
+    std::string kind;
+    std::string rest = body;
+    for (const char* prefix : {"video", "images", "y4m", "raw", "v4l2", "synthetic"}) {
+        std::string name(prefix);
+        if (body == name || body.rfind(name + ":", 0) == 0) {
+            kind = name;
+            rest = body.size() > name.size() ? body.substr(name.size() + 1) : "";
+            break;
+        }
+    }
+    if (kind.empty()) {
+        if (cv::utils::fs::isDirectory(body)) {
+            kind = "images";
+        } else if (endsWith(body, ".y4m")) {
+            kind = "y4m";
+        } else {
+            kind = "video";
+        }
+    }
+
+    std::unique_ptr<FrameSource> source;
+    if (kind == "synthetic") {
+        cv::Size size(960, 540);
+        if (!rest.empty() && !parseSize(rest, size)) {
+            std::cerr << "Bad synthetic size '" << rest << "' (use WxH)" << std::endl;
+            return nullptr;
+        }
+        source.reset(new SyntheticSource(size, fps));
+    } else if (kind == "images") {
+        auto images = std::unique_ptr<ImageSequenceSource>(new ImageSequenceSource());
+        if (images->open(rest, fps)) {
+            source = std::move(images);
+        }
+    } else if (kind == "y4m") {
+        auto mapped = std::unique_ptr<MappedSource>(new MappedSource());
+        if (mapped->openY4m(rest)) {
+            source = std::move(mapped);
+        }
+    } else if (kind == "raw") {
+        MappedSource::Packing format = MappedSource::Packing::BGR;
+        size_t colon = rest.rfind(':');
+        if (colon != std::string::npos) {
+            std::string suffix = rest.substr(colon + 1);
+            if (suffix == "bgr" || suffix == "i420" || suffix == "nv12") {
+                format = suffix == "i420" ? MappedSource::Packing::I420
+                       : suffix == "nv12" ? MappedSource::Packing::NV12 : MappedSource::Packing::BGR;
+                rest = rest.substr(0, colon);
+                colon = rest.rfind(':');
+            }
+        }
+        cv::Size size;
+        if (colon == std::string::npos || !parseSize(rest.substr(colon + 1), size)) {
+            std::cerr << "Raw sources need a frame size: raw:<file>:<W>x<H>[:bgr|i420|nv12]" << std::endl;
+            return nullptr;
+        }
+        auto mapped = std::unique_ptr<MappedSource>(new MappedSource());
+        if (mapped->openRaw(rest.substr(0, colon), size, format, fps)) {
+            source = std::move(mapped);
+        }
+    } else if (kind == "v4l2") {
+        auto device = std::unique_ptr<V4l2Source>(new V4l2Source());
+        if (device->open(rest.empty() ? "0" : rest)) {
+            source = std::move(device);
+        }
+    } else {
+        auto video = std::unique_ptr<VideoFileSource>(new VideoFileSource());
+        if (video->open(rest)) {
+            source = std::move(video);
+        }
+    }
+
+    if (!source) {
+        std::cerr << "Could not open frame source '" << spec << "'" << std::endl;
+    }
+    return source;
+}
@@ -0,0 +1,58 @@
+#ifndef FRAME_SOURCE_H
+#define FRAME_SOURCE_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// How a source's frames are laid out in memory. The planar layouts are (h * 3 / 2) x w CV_8UC1:
+// the full-size Y plane followed by U then V (I420) or one interleaved UV plane (NV12), both at
+// half resolution
+enum class PixelLayout {
+    BGR,
+    I420,
+    NV12
+};
+
+// BGR copy of a frame in any layout; a BGR frame is passed through without copying
+void convertToBgr(const cv::Mat& frame, PixelLayout layout, cv::Mat& bgr);
+
+// Where raw frames come from. Every source loops at its end, so playback code never special-cases
+// the last frame; live devices simply never end.
+class FrameSource {
+public:
+    virtual ~FrameSource() = default;
+
+    // Next frame, in layout(). It may point into memory owned by the source (memory-mapped files) and stays
+    // valid until the source is destroyed; callers must not write to it
+    virtual bool read(cv::Mat& frame) = 0;
+    // Back to the first frame; false for live devices
+    virtual bool rewind() = 0;
+    virtual double fps() const = 0;
+    virtual std::string name() const = 0;
+    // Sources that already hold 4:2:0 planes hand them out as is, so the display can convert on the GPU
+    virtual PixelLayout layout() const { return PixelLayout::BGR; }
+
+    // Random access, for sources of known length. A negative count marks a stream (devices,
+    // synthetic), which only supports read() and rewind().
+    virtual int64_t frameCount() const { return -1; }
+    // Index of the frame the next read() returns
+    virtual int64_t position() const { return -1; }
+    virtual bool seek(int64_t index) { (void)index; return false; }
+    // Closest frame at or before index that a seek can land on without decoding from further back
+    virtual int64_t keyframeBefore(int64_t index) const { return index; }
+};
+
+// Opens a source from a spec, with an optional "@fps" suffix for sources without a rate of their own:
+//   video:<file>                     anything cv::VideoCapture decodes
+//   images:<directory>[@fps]         image files in name order
+//   y4m:<file>                       YUV4MPEG2 (4:2:0, 4:4:4 or mono), memory-mapped; 4:2:0 stays I420
+//   raw:<file>:<W>x<H>[:fmt][@fps]   frames back to back, memory-mapped, zero-copy; fmt is bgr
+//                                    (packed BGR24, the default), i420 or nv12
+//   v4l2:<device or index>           capture device through OpenCV's V4L2 backend
+//   synthetic[:<W>x<H>][@fps]        deterministic test pattern, the same pixels on every run
+// A bare path is a directory of images, a .y4m file or a video. Returns nullptr on failure.
+std::unique_ptr<FrameSource> openFrameSource(const std::string& spec);
+
+#endif
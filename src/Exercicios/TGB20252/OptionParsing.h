@@ -0,0 +1,41 @@
+#ifndef OPTION_PARSING_H
+#define OPTION_PARSING_H
+
+#include <cmath>
+#include <exception>
+#include <string>
+
+// Numeric command-line values. The whole text must be the number and it must be in range, so a
+// typo is reported instead of silently becoming 0 the way atoi/atof would turn it
+
+// A number no lower than minValue (exclusive when positive is set)
+inline bool parseNumberOption(const std::string& text, double minValue, bool positive, double& value) {
+    try {
+        size_t used = 0;
+        double parsed = std::stod(text, &used);
+        if (used != text.size() || !std::isfinite(parsed) || parsed < minValue || (positive && parsed == minValue)) {
+            return false;
+        }
+        value = parsed;
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+// An integer in [minValue, maxValue]
+inline bool parseNumberOption(const std::string& text, int minValue, int maxValue, int& value) {
+    try {
+        size_t used = 0;
+        int parsed = std::stoi(text, &used);
+        if (used != text.size() || parsed < minValue || parsed > maxValue) {
+            return false;
+        }
+        value = parsed;
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+#endif
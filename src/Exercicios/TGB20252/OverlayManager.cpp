@@ -1,4 +1,6 @@
 #include "OverlayManager.h"
+#include "PixelKernels.h"
+#include <algorithm>
 
 namespace {
 struct OverlayAsset {
@@ -27,6 +29,51 @@ void OverlayManager::load(int width, int height) {
         }
         textures[asset.type] = img;
     }
+
+    buildPlanes();
+}
+
+void OverlayManager::setPrecision(IntermediatePrecision value) {
+    if (value == precision) {
+        return;
+    }
+    precision = value;
+    buildPlanes();
+}
+
+IntermediatePrecision OverlayManager::getPrecision() const {
+    return precision;
+}
+
+void OverlayManager::buildPlanes() {
+    planes.clear();
+    for (const auto& entry : textures) {
+        const cv::Mat& overlay = entry.second;
+        if (overlay.empty()) {
+            continue;
+        }
+
+        cv::Mat overlayColor;
+        cv::Mat alphaChannel;
+        if (overlay.channels() == 4) {
+            std::vector<cv::Mat> channels;
+            cv::split(overlay, channels);
+            std::vector<cv::Mat> bgr(channels.begin(), channels.begin() + 3);
+            cv::merge(bgr, overlayColor);
+            alphaChannel = channels[3];
+        } else if (overlay.channels() == 1) {
+            cv::cvtColor(overlay, overlayColor, cv::COLOR_GRAY2BGR);
+            alphaChannel = cv::Mat(overlay.rows, overlay.cols, CV_8UC1, cv::Scalar(255));
+        } else {
+            overlayColor = overlay;
+            alphaChannel = cv::Mat(overlay.rows, overlay.cols, CV_8UC1, cv::Scalar(255));
+        }
+
+        OverlayPlanes converted;
+        converted.color = toWorkingStorage(overlayColor, precision);
+        converted.alpha = toWorkingStorage(alphaChannel, precision);
+        planes[entry.first] = converted;
+    }
 }
 
 const std::vector<OverlayOption>& OverlayManager::options() const {
@@ -34,92 +81,61 @@ const std::vector<OverlayOption>& OverlayManager::options() const {
 }
 
 cv::Mat OverlayManager::apply(const cv::Mat& base, OverlayType type) const {
-    if (type == OverlayType::NONE || base.empty()) {
+    if (type == OverlayType::NONE || base.empty() || base.type() != CV_8UC3) {
         return base;
     }
 
-    auto it = textures.find(type);
-    if (it == textures.end() || it->second.empty()) {
+    cv::Mat result(base.size(), CV_8UC3);
+    if (!blendRegion(base, result, type, cv::Point(0, 0))) {
         return base;
     }
+    return result;
+}
+
+void OverlayManager::applyInPlace(cv::Mat& region, OverlayType type, cv::Point origin) const {
+    if (type == OverlayType::NONE || region.empty() || region.type() != CV_8UC3) {
+        return;
+    }
+    blendRegion(region, region, type, origin);
+}
 
-    cv::Mat overlay = it->second;
-    cv::Mat overlayColor = overlay;
-    cv::Mat alphaChannel;
-    if (overlay.channels() == 4) {
-        std::vector<cv::Mat> channels;
-        cv::split(overlay, channels);
-        std::vector<cv::Mat> bgr(channels.begin(), channels.begin() + 3);
-        cv::merge(bgr, overlayColor);
-        alphaChannel = channels[3];
-    } else {
-        alphaChannel = cv::Mat(overlay.rows, overlay.cols, CV_8UC1, cv::Scalar(255));
+bool OverlayManager::blendRegion(const cv::Mat& base, cv::Mat& dst, OverlayType type, cv::Point origin) const {
+    auto it = planes.find(type);
+    if (it == planes.end()) {
+        return false;
+    }
+    const OverlayPlanes& overlay = it->second;
+    if (origin.x < 0 || origin.y < 0 || origin.x + base.cols > overlay.color.cols || origin.y + base.rows > overlay.color.rows) {
+        return false;
     }
 
-    cv::Mat baseFloat;
-    cv::Mat overlayFloat;
-    cv::Mat alphaFloat;
-    base.convertTo(baseFloat, CV_32FC3, 1.0f / 255.0f);
-    overlayColor.convertTo(overlayFloat, CV_32FC3, 1.0f / 255.0f);
-    alphaChannel.convertTo(alphaFloat, CV_32FC1, 1.0f / 255.0f);
-    cv::Mat alphaFloat3;
-    cv::Mat alphaChannels[] = {alphaFloat, alphaFloat, alphaFloat};
-    cv::merge(alphaChannels, 3, alphaFloat3);
-
-    cv::Mat blended;
+    const PixelKernels& kernels = pixelKernels();
+    BlendRowKernel blend = nullptr;
     switch (type) {
-        case OverlayType::HLA_GLYPH: {
-            std::vector<cv::Mat> baseCh(3), overlayCh(3), burnCh(3);
-            cv::split(baseFloat, baseCh);
-            cv::split(overlayFloat, overlayCh);
-            for (int i = 0; i < 3; ++i) {
-                cv::Mat denom = overlayCh[i].clone();
-                cv::Mat zeroMask;
-                cv::compare(denom, 1e-4f, zeroMask, cv::CMP_LT);
-                denom.setTo(1e-4f, zeroMask);
-                cv::Mat invDenom;
-                cv::divide(1.0f, denom, invDenom);
-                cv::Mat channel = 1.0f - (1.0f - baseCh[i]).mul(invDenom);
-                channel.setTo(0.0f, zeroMask);
-                burnCh[i] = channel;
-            }
-            cv::merge(burnCh, blended);
+        case OverlayType::HLA_GLYPH:
+            blend = kernels.colorBurnRow;
             break;
-        }
-        case OverlayType::HIPSTER: {
-            blended = baseFloat + overlayFloat - 2.0f * baseFloat.mul(overlayFloat);
+        case OverlayType::HIPSTER:
+            blend = kernels.exclusionRow;
             break;
-        }
-        case OverlayType::SUMMER: {
-            std::vector<cv::Mat> baseCh(3), overlayCh(3), blendedCh(3);
-            cv::split(baseFloat, baseCh);
-            cv::split(overlayFloat, overlayCh);
-            for (int i = 0; i < 3; ++i) {
-                cv::Mat dodge = baseCh[i] + 2.0f * (overlayCh[i] - 0.5f);
-                cv::min(dodge, 1.0f, dodge);
-                cv::Mat burn = baseCh[i] + 2.0f * overlayCh[i] - 1.0f;
-                cv::max(burn, 0.0f, burn);
-                cv::Mat hiMask;
-                cv::Mat loMask;
-                cv::compare(overlayCh[i], 0.5f, hiMask, cv::CMP_GE);
-                cv::compare(overlayCh[i], 0.5f, loMask, cv::CMP_LT);
-                cv::Mat channelResult = cv::Mat::zeros(baseCh[i].size(), baseCh[i].type());
-                dodge.copyTo(channelResult, hiMask);
-                burn.copyTo(channelResult, loMask);
-                blendedCh[i] = channelResult;
-            }
-            cv::merge(blendedCh, blended);
+        case OverlayType::SUMMER:
+            blend = kernels.linearLightRow;
             break;
-        }
         default:
-            return base;
+            return false;
     }
 
-    cv::max(blended, 0.0f, blended);
-    cv::min(blended, 1.0f, blended);
-
-    cv::Mat resultFloat = baseFloat.mul(1.0f - alphaFloat3) + blended.mul(alphaFloat3);
-    cv::Mat result8U;
-    resultFloat.convertTo(result8U, CV_8UC3, 255.0f);
-    return result8U;
+    // Rows are unpacked into FP32 scratch buffers that stay in cache; no frame-sized float copies are made.
+    // Each row is fully loaded before it is stored, so dst may alias base.
+    int cols = base.cols;
+    int overlayCols = overlay.color.cols;
+    std::vector<float> baseRow(cols * 3), overlayRow(overlayCols * 3), alphaRow(overlayCols), outRow(cols * 3);
+    for (int y = 0; y < base.rows; ++y) {
+        loadRow(base, y, baseRow.data());
+        loadRow(overlay.color, origin.y + y, overlayRow.data());
+        loadRow(overlay.alpha, origin.y + y, alphaRow.data());
+        blend(baseRow.data(), overlayRow.data() + origin.x * 3, alphaRow.data() + origin.x, outRow.data(), cols);
+        storeRow8U(outRow.data(), dst.ptr<uchar>(y), cols * 3);
+    }
+    return true;
 }
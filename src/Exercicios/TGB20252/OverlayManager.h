@@ -6,6 +6,8 @@
 #include <unordered_map>
 #include <vector>
 
+#include "PixelPrecision.h"
+
 enum class OverlayType {
     NONE = 0,
     HLA_GLYPH,
@@ -23,12 +25,28 @@ class OverlayManager {
 public:
     void load(int width, int height);
     cv::Mat apply(const cv::Mat& base, OverlayType type) const;
+    // Blends into a window of the frame whose top-left corner sits at origin (used by tiled execution)
+    void applyInPlace(cv::Mat& region, OverlayType type, cv::Point origin) const;
     const std::vector<OverlayOption>& options() const;
 
+    void setPrecision(IntermediatePrecision value);
+    IntermediatePrecision getPrecision() const;
+
 private:
+    // Overlay color and alpha pre-converted to working storage, so apply() only streams the base frame
+    struct OverlayPlanes {
+        cv::Mat color;
+        cv::Mat alpha;
+    };
+
     std::vector<OverlayOption> entries;
     std::unordered_map<OverlayType, cv::Mat> textures;
+    std::unordered_map<OverlayType, OverlayPlanes> planes;
     cv::Size targetSize{0, 0};
+    IntermediatePrecision precision{IntermediatePrecision::FLOAT32};
+
+    void buildPlanes();
+    bool blendRegion(const cv::Mat& base, cv::Mat& dst, OverlayType type, cv::Point origin) const;
 };
 
 #endif
@@ -0,0 +1,255 @@
+#include "PhotoGallery.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+// Texture uploads per frame; each is a small glTexImage2D, so this only spreads a burst of results
+const int kUploadsPerFrame = 4;
+
+std::string fileName(const std::string& path) {
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+bool isCapture(const std::string& name) {
+    size_t dot = name.rfind('.');
+    if (name.rfind("viapp_", 0) != 0 || dot == std::string::npos) {
+        return false;
+    }
+    std::string extension = name.substr(dot);
+    return extension == ".png" || extension == ".jpg" || extension == ".webp";
+}
+
+// viapp_<kind>_<unix time>[_<n>]: the time field orders captures of every kind together
+long long captureTime(const std::string& name) {
+    size_t first = name.find('_', 6);
+    return first == std::string::npos ? 0 : std::atoll(name.c_str() + first + 1);
+}
+}
+
+PhotoGallery::PhotoGallery(const std::string& directory, int thumbWidth, size_t cacheBytes, int workers)
+    : directory(directory), width(std::max(16, thumbWidth)), byteBudget(cacheBytes), workerCount(std::max(1, workers)) {}
+
+PhotoGallery::~PhotoGallery() {
+    stop();
+}
+
+void PhotoGallery::startWorkers() {
+    if (!running) {
+        running = true;
+        for (int i = 0; i < workerCount; ++i) {
+            workers.emplace_back(&PhotoGallery::workerLoop, this);
+        }
+    }
+}
+
+void PhotoGallery::refresh() {
+    // Files that failed to decode may have been half-written at the time
+    failed.clear();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        scanRequested = true;
+        scanning = true;
+        startWorkers();
+    }
+    wake.notify_one();
+}
+
+bool PhotoGallery::isScanning() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return scanning;
+}
+
+int PhotoGallery::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<int>(files.size());
+}
+
+std::string PhotoGallery::name(int index) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return index >= 0 && index < static_cast<int>(files.size()) ? fileName(files[index]) : std::string();
+}
+
+void PhotoGallery::beginFrame() {
+    std::vector<Decoded> finished;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        // Anything still wanted is requested again while drawing this frame
+        requests.clear();
+        int count = std::min(kUploadsPerFrame, static_cast<int>(ready.size()));
+        finished.assign(std::make_move_iterator(ready.begin()), std::make_move_iterator(ready.begin() + count));
+        ready.erase(ready.begin(), ready.begin() + count);
+        // Paths stay in flight until uploaded so thumbnail() does not queue them a second time
+        for (const auto& item : finished) {
+            inFlight.erase(item.path);
+        }
+    }
+
+    for (auto& item : finished) {
+        if (item.thumb.empty()) {
+            failed.insert(item.path);
+            continue;
+        }
+        if (cache.count(item.path)) {
+            continue;
+        }
+        lru.emplace_front();
+        Entry& entry = lru.front();
+        entry.path = item.path;
+        entry.size = item.thumb.size();
+        entry.bytes = item.thumb.total() * item.thumb.elemSize();
+        entry.texture.createTexture(entry.size.width, entry.size.height);
+        entry.texture.updateTexture(item.thumb);
+        cache[entry.path] = lru.begin();
+        usedBytes += entry.bytes;
+    }
+
+    while (usedBytes > byteBudget && lru.size() > 1) {
+        Entry& oldest = lru.back();
+        usedBytes -= oldest.bytes;
+        cache.erase(oldest.path);
+        lru.pop_back();
+    }
+}
+
+GLuint PhotoGallery::thumbnail(int index, cv::Size& size) {
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (index < 0 || index >= static_cast<int>(files.size())) {
+            return 0;
+        }
+        path = files[index];
+    }
+
+    auto found = cache.find(path);
+    if (found != cache.end()) {
+        lru.splice(lru.begin(), lru, found->second);
+        size = found->second->size;
+        return found->second->texture.getTextureID();
+    }
+    if (failed.count(path)) {
+        return 0;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!inFlight.count(path)) {
+            requests.push_back(path);
+            startWorkers();
+        }
+    }
+    wake.notify_one();
+    return 0;
+}
+
+bool PhotoGallery::busy() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return scanning || !inFlight.empty();
+}
+
+int PhotoGallery::thumbWidth() const {
+    return width;
+}
+
+size_t PhotoGallery::cacheBytes() const {
+    return usedBytes;
+}
+
+int PhotoGallery::cachedCount() const {
+    return static_cast<int>(lru.size());
+}
+
+void PhotoGallery::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+        requests.clear();
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers.clear();
+}
+
+void PhotoGallery::cleanup() {
+    cache.clear();
+    lru.clear();
+    failed.clear();
+    usedBytes = 0;
+}
+
+void PhotoGallery::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return !running || scanRequested || !requests.empty(); });
+        if (!running) {
+            break;
+        }
+        if (scanRequested) {
+            scanRequested = false;
+            lock.unlock();
+            scan();
+            lock.lock();
+            continue;
+        }
+
+        // Newest request first: that is what the user scrolled to last
+        std::string path = std::move(requests.back());
+        requests.pop_back();
+        if (!inFlight.insert(path).second) {
+            continue;
+        }
+        lock.unlock();
+        cv::Mat thumb = decodeThumbnail(path);
+        lock.lock();
+        ready.push_back({path, thumb});
+    }
+}
+
+void PhotoGallery::scan() {
+    std::vector<cv::String> found;
+    try {
+        cv::glob(directory + "/viapp_*", found, false);
+    } catch (const cv::Exception& e) {
+        std::cerr << "Gallery scan error: " << e.what() << std::endl;
+    }
+
+    std::vector<std::string> captures;
+    for (const auto& path : found) {
+        if (isCapture(fileName(path))) {
+            captures.push_back(path);
+        }
+    }
+    std::sort(captures.begin(), captures.end(), [](const std::string& a, const std::string& b) {
+        long long ta = captureTime(fileName(a));
+        long long tb = captureTime(fileName(b));
+        return ta != tb ? ta > tb : a < b;
+    });
+
+    std::lock_guard<std::mutex> lock(mutex);
+    files = std::move(captures);
+    scanning = false;
+}
+
+// Captures are at least window-sized, so a quarter-size decode still covers the thumbnail. JPEG
+// decodes straight to that size through DCT scaling; PNG and WebP are reduced inside imread
+cv::Mat PhotoGallery::decodeThumbnail(const std::string& path) const {
+    cv::Mat image;
+    try {
+        image = cv::imread(path, cv::IMREAD_REDUCED_COLOR_4);
+    } catch (const cv::Exception& e) {
+        std::cerr << "Gallery decode error: " << e.what() << std::endl;
+    }
+    if (image.empty() || image.cols <= width) {
+        return image;
+    }
+    cv::Mat thumb;
+    int height = std::max(1, image.rows * width / image.cols);
+    cv::resize(image, thumb, cv::Size(width, height), 0, 0, cv::INTER_AREA);
+    return thumb;
+}
@@ -0,0 +1,85 @@
+#ifndef PHOTO_GALLERY_H
+#define PHOTO_GALLERY_H
+
+#include <glad/glad.h>
+#include <opencv2/opencv.hpp>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "TextureManager.h"
+
+// Lists the captures saved by the app and serves their thumbnails to the ImGui gallery. Directory
+// scans and decodes run on worker threads; the render thread only uploads a few finished thumbnails
+// per frame into a byte-bounded LRU of textures. Decode requests are rebuilt every frame from what is
+// on screen, so scrolling past thousands of photos never queues work for the ones already gone.
+class PhotoGallery {
+public:
+    explicit PhotoGallery(const std::string& directory, int thumbWidth = 96, size_t cacheBytes = 32 << 20, int workers = 2);
+    ~PhotoGallery();
+
+    void refresh();
+    bool isScanning() const;
+    int size() const;
+    std::string name(int index) const;
+
+    // Render thread, once per frame before drawing: uploads decoded thumbnails, drops stale requests
+    void beginFrame();
+    // Texture for photo index, or 0 while it is being decoded (a decode is queued on a miss)
+    GLuint thumbnail(int index, cv::Size& size);
+    bool busy() const;
+
+    int thumbWidth() const;
+    size_t cacheBytes() const;
+    int cachedCount() const;
+
+    void stop();
+    // Deletes the textures; needs the GL context
+    void cleanup();
+
+private:
+    struct Entry {
+        std::string path;
+        TextureManager texture;
+        cv::Size size;
+        size_t bytes{0};
+    };
+    struct Decoded {
+        std::string path;
+        cv::Mat thumb;
+    };
+
+    std::string directory;
+    int width;
+    size_t byteBudget;
+    int workerCount;
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<std::thread> workers;
+    std::vector<std::string> files;
+    std::vector<std::string> requests;
+    std::unordered_set<std::string> inFlight;
+    std::vector<Decoded> ready;
+    bool scanRequested{false};
+    bool scanning{false};
+    bool running{false};
+
+    // Render thread only
+    std::list<Entry> lru;
+    std::unordered_map<std::string, std::list<Entry>::iterator> cache;
+    std::unordered_set<std::string> failed;
+    size_t usedBytes{0};
+
+    void startWorkers();
+    void workerLoop();
+    void scan();
+    cv::Mat decodeThumbnail(const std::string& path) const;
+};
+
+#endif
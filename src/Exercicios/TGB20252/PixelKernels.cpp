@@ -0,0 +1,134 @@
+#include "PixelKernels.inl"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#if defined(VIAPP_ISA_DISPATCH)
+const PixelKernels* pixelKernelsSse2();
+const PixelKernels* pixelKernelsAvx2();
+const PixelKernels* pixelKernelsAvx512();
+#endif
+
+namespace {
+const PixelKernels* scalarKernels() {
+    static const PixelKernels kernels = makePixelKernels();
+    return &kernels;
+}
+
+const PixelKernels* kernelTable(CpuIsa isa) {
+    switch (isa) {
+#if defined(VIAPP_ISA_DISPATCH)
+        case CpuIsa::SSE2:
+            return pixelKernelsSse2();
+        case CpuIsa::AVX2:
+            return pixelKernelsAvx2();
+        case CpuIsa::AVX512:
+            return pixelKernelsAvx512();
+#endif
+        default:
+            return scalarKernels();
+    }
+}
+
+CpuIsa initialIsa() {
+    CpuIsa isa = detectCpuIsa();
+    const char* forced = std::getenv("VIAPP_ISA");
+    if (forced && *forced) {
+        CpuIsa requested;
+        if (!parseCpuIsa(forced, requested)) {
+            std::cerr << "VIAPP_ISA: unknown ISA '" << forced << "'" << std::endl;
+        } else if (!isCpuIsaAvailable(requested)) {
+            std::cerr << "VIAPP_ISA: " << cpuIsaName(requested) << " is not available, using " << cpuIsaName(isa) << std::endl;
+        } else {
+            isa = requested;
+        }
+    }
+    return isa;
+}
+
+std::atomic<CpuIsa>& activeIsa() {
+    static std::atomic<CpuIsa> isa{initialIsa()};
+    return isa;
+}
+}
+
+const char* cpuIsaName(CpuIsa isa) {
+    switch (isa) {
+        case CpuIsa::SSE2:
+            return "sse2";
+        case CpuIsa::AVX2:
+            return "avx2";
+        case CpuIsa::AVX512:
+            return "avx512";
+        default:
+            return "scalar";
+    }
+}
+
+bool parseCpuIsa(const char* text, CpuIsa& isa) {
+    const CpuIsa all[] = {CpuIsa::SCALAR, CpuIsa::SSE2, CpuIsa::AVX2, CpuIsa::AVX512};
+    for (CpuIsa candidate : all) {
+        if (std::strcmp(text, cpuIsaName(candidate)) == 0) {
+            isa = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool isCpuIsaAvailable(CpuIsa isa) {
+    if (isa == CpuIsa::SCALAR) {
+        return true;
+    }
+#if defined(VIAPP_ISA_DISPATCH)
+    __builtin_cpu_init();
+    switch (isa) {
+        case CpuIsa::SSE2:
+            return __builtin_cpu_supports("sse2");
+        case CpuIsa::AVX2:
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        case CpuIsa::AVX512:
+            return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+                   __builtin_cpu_supports("avx512vl");
+        default:
+            break;
+    }
+#endif
+    return false;
+}
+
+CpuIsa detectCpuIsa() {
+    const CpuIsa preference[] = {CpuIsa::AVX512, CpuIsa::AVX2, CpuIsa::SSE2};
+    for (CpuIsa isa : preference) {
+        if (isCpuIsaAvailable(isa)) {
+            return isa;
+        }
+    }
+    return CpuIsa::SCALAR;
+}
+
+bool forceCpuIsa(CpuIsa isa) {
+    if (!isCpuIsaAvailable(isa)) {
+        return false;
+    }
+    activeIsa().store(isa);
+    return true;
+}
+
+CpuIsa activeCpuIsa() {
+    return activeIsa().load(std::memory_order_relaxed);
+}
+
+const PixelKernels* pixelKernelsFor(CpuIsa isa) {
+    if (!isCpuIsaAvailable(isa)) {
+        return nullptr;
+    }
+    return kernelTable(isa);
+}
+
+const PixelKernels& pixelKernels() {
+    // activeIsa() only ever holds an available ISA, so the per-row lookup skips the cpuid check
+    return *kernelTable(activeCpuIsa());
+}
+
@@ -0,0 +1,53 @@
+#ifndef PIXEL_KERNELS_H
+#define PIXEL_KERNELS_H
+
+#include <cstdint>
+
+// Only plain C++ here: this header is compiled once per ISA (see PixelKernels.inl), and inline code
+// from library headers built with AVX flags could leak into the baseline build through the linker.
+
+enum class CpuIsa {
+    SCALAR,
+    SSE2,
+    AVX2,
+    AVX512
+};
+
+// Overlay blend of FP32 rows in [0, 1]: base/overlay/out hold cols * 3 samples, alpha one value per pixel
+using BlendRowKernel = void (*)(const float* base, const float* overlay, const float* alpha, float* out, int cols);
+
+struct PixelKernels {
+    // Blends a BGRA sticker row over a BGR row in place, scaled by a global alpha
+    void (*blendBgraOverBgr)(uint8_t* bgr, const uint8_t* bgra, int pixels, float alpha);
+    // Source coordinates of the VHS chromatic aberration for row y (red pushed outward, blue inward)
+    void (*aberrationMapRow)(float* mapXRed, float* mapYRed, float* mapXBlue, float* mapYBlue,
+                             int y, int cols, int rows, float strength);
+    BlendRowKernel colorBurnRow;
+    BlendRowKernel exclusionRow;
+    BlendRowKernel linearLightRow;
+    // Copies a BGR row zeroing the channels whose keep flag is false; src may equal dst
+    void (*maskChannels)(const uint8_t* src, uint8_t* dst, int pixels, bool keepB, bool keepG, bool keepR);
+    // Unpacks count IEEE half floats (a CV_16F row) to FP32
+    void (*halfToFloatRow)(const uint16_t* src, float* dst, int count);
+    // Averages each BGR pixel of current with the pixels of the history rows whose largest channel
+    // difference is within threshold (rounded half up); at most 255 history rows
+    void (*temporalDenoiseRow)(const uint8_t* current, const uint8_t* const* history, int frames, uint8_t* out,
+                               int pixels, int threshold);
+};
+
+const char* cpuIsaName(CpuIsa isa);
+bool parseCpuIsa(const char* text, CpuIsa& isa);
+
+// Best ISA that both this build and the running CPU support
+CpuIsa detectCpuIsa();
+bool isCpuIsaAvailable(CpuIsa isa);
+
+// Forces the kernels of a given ISA (for testing and benchmarks); fails if it is not available.
+// The VIAPP_ISA environment variable does the same at startup.
+bool forceCpuIsa(CpuIsa isa);
+CpuIsa activeCpuIsa();
+
+const PixelKernels& pixelKernels();
+const PixelKernels* pixelKernelsFor(CpuIsa isa);
+
+#endif
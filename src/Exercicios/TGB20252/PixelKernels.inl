@@ -0,0 +1,184 @@
+// Kernel bodies shared by every ISA build. Each PixelKernels*.cpp includes this file once and is
+// compiled with its own -m flags, so the loops below are auto-vectorised for that instruction set.
+// Everything lives in an anonymous namespace and no library headers are pulled in, keeping the
+// per-ISA copies from colliding at link time. The only exceptions are <cstring>, which declares
+// nothing inline, and the F16C intrinsics, which are builtins with no out-of-line definition.
+
+#include "PixelKernels.h"
+#include <cstring>
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+namespace {
+inline float clampUnit(float value) {
+    return value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+}
+
+inline uint8_t toByte(float value) {
+    value = value < 0.0f ? 0.0f : (value > 255.0f ? 255.0f : value);
+    return static_cast<uint8_t>(static_cast<int>(value + 0.5f));
+}
+
+void blendBgraOverBgr(uint8_t* bgr, const uint8_t* bgra, int pixels, float alpha) {
+    // Branch-free: a transparent pixel blends to the unchanged background value
+    for (int x = 0; x < pixels; ++x) {
+        float a = (bgra[x * 4 + 3] * (1.0f / 255.0f)) * alpha;
+        float keep = 1.0f - a;
+        bgr[x * 3 + 0] = toByte(keep * bgr[x * 3 + 0] + a * bgra[x * 4 + 0]);
+        bgr[x * 3 + 1] = toByte(keep * bgr[x * 3 + 1] + a * bgra[x * 4 + 1]);
+        bgr[x * 3 + 2] = toByte(keep * bgr[x * 3 + 2] + a * bgra[x * 4 + 2]);
+    }
+}
+
+void aberrationMapRow(float* mapXRed, float* mapYRed, float* mapXBlue, float* mapYBlue,
+                      int y, int cols, int rows, float strength) {
+    float cx = cols * 0.5f;
+    float cy = rows * 0.5f;
+    float offsetY = strength * ((y - cy) / rows);
+    float fy = static_cast<float>(y);
+    for (int x = 0; x < cols; ++x) {
+        float offsetX = strength * ((x - cx) / cols);
+        mapXRed[x] = static_cast<float>(x) + offsetX;
+        mapYRed[x] = fy + offsetY;
+        mapXBlue[x] = static_cast<float>(x) - offsetX;
+        mapYBlue[x] = fy - offsetY;
+    }
+}
+
+inline float colorBurn(float base, float blend) {
+    return blend < 1e-4f ? 0.0f : 1.0f - (1.0f - base) / blend;
+}
+
+inline float exclusion(float base, float blend) {
+    return base + blend - 2.0f * base * blend;
+}
+
+inline float linearLight(float base, float blend) {
+    return blend >= 0.5f ? clampUnit(base + 2.0f * (blend - 0.5f)) : clampUnit(base + 2.0f * blend - 1.0f);
+}
+
+template <float (*Blend)(float, float)>
+void blendRow(const float* base, const float* overlay, const float* alpha, float* out, int cols) {
+    for (int x = 0; x < cols; ++x) {
+        float a = alpha[x];
+        for (int c = 0; c < 3; ++c) {
+            int i = x * 3 + c;
+            out[i] = base[i] * (1.0f - a) + clampUnit(Blend(base[i], overlay[i])) * a;
+        }
+    }
+}
+
+void maskChannels(const uint8_t* src, uint8_t* dst, int pixels, bool keepB, bool keepG, bool keepR) {
+    const uint8_t maskB = keepB ? 0xFF : 0;
+    const uint8_t maskG = keepG ? 0xFF : 0;
+    const uint8_t maskR = keepR ? 0xFF : 0;
+    for (int x = 0; x < pixels; ++x) {
+        dst[x * 3 + 0] = src[x * 3 + 0] & maskB;
+        dst[x * 3 + 1] = src[x * 3 + 1] & maskG;
+        dst[x * 3 + 2] = src[x * 3 + 2] & maskR;
+    }
+}
+
+inline float halfToFloat(uint16_t half) {
+    uint32_t sign = static_cast<uint32_t>(half & 0x8000u) << 16;
+    uint32_t exponent = (half >> 10) & 0x1Fu;
+    uint32_t mantissa = half & 0x3FFu;
+    uint32_t bits;
+
+    if (exponent == 0) {
+        if (mantissa == 0) {
+            bits = sign;
+        } else {
+            exponent = 127 - 15 + 1;
+            while (!(mantissa & 0x400u)) {
+                mantissa <<= 1;
+                --exponent;
+            }
+            bits = sign | (exponent << 23) | ((mantissa & 0x3FFu) << 13);
+        }
+    } else if (exponent == 0x1F) {
+        bits = sign | 0x7F800000u | (mantissa << 13);
+    } else {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// The bit manipulation does not auto-vectorise; the AVX2 and AVX-512 builds add -mf16c (every
+// CPU with AVX2 has F16C) and convert eight halves per instruction instead
+void halfToFloatRow(const uint16_t* src, float* dst, int count) {
+    int i = 0;
+#if defined(__F16C__)
+    for (; i + 8 <= count; i += 8) {
+        __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(packed));
+    }
+#endif
+    for (; i < count; ++i) {
+        dst[i] = halfToFloat(src[i]);
+    }
+}
+
+// Frame-outer over fixed chunks so the per-pixel select and sums vectorise; the final divide runs in
+// float, which is exact here because sums stay far below 2^24 and a non-integer quotient is at
+// least 1/used away from the next integer
+void temporalDenoiseRow(const uint8_t* current, const uint8_t* const* history, int frames, uint8_t* out,
+                        int pixels, int threshold) {
+    const int chunk = 256;
+    uint16_t sum[chunk * 3];
+    uint16_t used[chunk];
+    for (int x0 = 0; x0 < pixels; x0 += chunk) {
+        int n = pixels - x0 < chunk ? pixels - x0 : chunk;
+        const uint8_t* c = current + x0 * 3;
+        for (int i = 0; i < n * 3; ++i) {
+            sum[i] = c[i];
+        }
+        for (int x = 0; x < n; ++x) {
+            used[x] = 1;
+        }
+        for (int f = 0; f < frames; ++f) {
+            const uint8_t* p = history[f] + x0 * 3;
+            for (int x = 0; x < n; ++x) {
+                int d0 = p[x * 3 + 0] - c[x * 3 + 0];
+                int d1 = p[x * 3 + 1] - c[x * 3 + 1];
+                int d2 = p[x * 3 + 2] - c[x * 3 + 2];
+                d0 = d0 < 0 ? -d0 : d0;
+                d1 = d1 < 0 ? -d1 : d1;
+                d2 = d2 < 0 ? -d2 : d2;
+                int diff = d0 > d1 ? (d0 > d2 ? d0 : d2) : (d1 > d2 ? d1 : d2);
+                uint16_t keep = diff <= threshold ? 1 : 0;
+                sum[x * 3 + 0] += keep * p[x * 3 + 0];
+                sum[x * 3 + 1] += keep * p[x * 3 + 1];
+                sum[x * 3 + 2] += keep * p[x * 3 + 2];
+                used[x] += keep;
+            }
+        }
+        uint8_t* o = out + x0 * 3;
+        for (int x = 0; x < n; ++x) {
+            float count = static_cast<float>(used[x]);
+            int half = used[x] / 2;
+            o[x * 3 + 0] = static_cast<uint8_t>(static_cast<int>((sum[x * 3 + 0] + half) / count));
+            o[x * 3 + 1] = static_cast<uint8_t>(static_cast<int>((sum[x * 3 + 1] + half) / count));
+            o[x * 3 + 2] = static_cast<uint8_t>(static_cast<int>((sum[x * 3 + 2] + half) / count));
+        }
+    }
+}
+
+PixelKernels makePixelKernels() {
+    PixelKernels kernels;
+    kernels.blendBgraOverBgr = blendBgraOverBgr;
+    kernels.aberrationMapRow = aberrationMapRow;
+    kernels.colorBurnRow = blendRow<colorBurn>;
+    kernels.exclusionRow = blendRow<exclusion>;
+    kernels.linearLightRow = blendRow<linearLight>;
+    kernels.maskChannels = maskChannels;
+    kernels.halfToFloatRow = halfToFloatRow;
+    kernels.temporalDenoiseRow = temporalDenoiseRow;
+    return kernels;
+}
+}
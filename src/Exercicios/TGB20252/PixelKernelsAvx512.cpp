@@ -0,0 +1,9 @@
+// AVX-512 build of the pixel kernels; CMake compiles this file with the matching -m flags
+#if defined(VIAPP_ISA_DISPATCH)
+#include "PixelKernels.inl"
+
+const PixelKernels* pixelKernelsAvx512() {
+    static const PixelKernels kernels = makePixelKernels();
+    return &kernels;
+}
+#endif
@@ -0,0 +1,9 @@
+// SSE2 build of the pixel kernels; CMake compiles this file with the matching -m flags
+#if defined(VIAPP_ISA_DISPATCH)
+#include "PixelKernels.inl"
+
+const PixelKernels* pixelKernelsSse2() {
+    static const PixelKernels kernels = makePixelKernels();
+    return &kernels;
+}
+#endif
@@ -0,0 +1,144 @@
+#include "PixelPrecision.h"
+#include "PixelKernels.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xFFu) - 127 + 15;
+    uint32_t mantissa = bits & 0x7FFFFFu;
+
+    if (exponent >= 0x1F) {
+        return static_cast<uint16_t>(sign | 0x7C00u);
+    }
+    if (exponent <= 0) {
+        if (exponent < -10) {
+            return static_cast<uint16_t>(sign);
+        }
+        mantissa |= 0x800000u;
+        uint32_t shift = static_cast<uint32_t>(14 - exponent);
+        uint32_t half = mantissa >> shift;
+        uint32_t rest = mantissa & ((1u << shift) - 1u);
+        uint32_t halfway = 1u << (shift - 1u);
+        if (rest > halfway || (rest == halfway && (half & 1u))) {
+            ++half;
+        }
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    uint32_t half = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+    uint32_t rest = mantissa & 0x1FFFu;
+    if (rest > 0x1000u || (rest == 0x1000u && (half & 1u))) {
+        ++half;
+    }
+    return static_cast<uint16_t>(half);
+}
+
+const std::array<uint16_t, 256>& unormToHalfTable() {
+    static const std::array<uint16_t, 256> table = [] {
+        std::array<uint16_t, 256> values{};
+        for (int i = 0; i < 256; ++i) {
+            values[i] = floatToHalf(i / 255.0f);
+        }
+        return values;
+    }();
+    return table;
+}
+}
+
+const char* precisionName(IntermediatePrecision precision) {
+    switch (precision) {
+        case IntermediatePrecision::FLOAT16:
+            return "fp16";
+        case IntermediatePrecision::FIXED16:
+            return "fixed16";
+        default:
+            return "fp32";
+    }
+}
+
+bool parsePrecision(const std::string& text, IntermediatePrecision& precision) {
+    if (text == "fp32") {
+        precision = IntermediatePrecision::FLOAT32;
+    } else if (text == "fp16") {
+        precision = IntermediatePrecision::FLOAT16;
+    } else if (text == "fixed16") {
+        precision = IntermediatePrecision::FIXED16;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+int precisionBytes(IntermediatePrecision precision) {
+    return precision == IntermediatePrecision::FLOAT32 ? 4 : 2;
+}
+
+cv::Mat toWorkingStorage(const cv::Mat& src, IntermediatePrecision precision) {
+    cv::Mat storage;
+    if (src.empty()) {
+        return storage;
+    }
+
+    switch (precision) {
+        case IntermediatePrecision::FIXED16:
+            src.convertTo(storage, CV_16U, 257.0);
+            break;
+        case IntermediatePrecision::FLOAT16: {
+            const auto& table = unormToHalfTable();
+            storage.create(src.rows, src.cols, CV_MAKETYPE(CV_16F, src.channels()));
+            int count = src.cols * src.channels();
+            for (int y = 0; y < src.rows; ++y) {
+                const uchar* in = src.ptr<uchar>(y);
+                uint16_t* out = storage.ptr<uint16_t>(y);
+                for (int i = 0; i < count; ++i) {
+                    out[i] = table[in[i]];
+                }
+            }
+            break;
+        }
+        default:
+            src.convertTo(storage, CV_32F, 1.0 / 255.0);
+            break;
+    }
+    return storage;
+}
+
+void loadRow(const cv::Mat& image, int row, float* dst) {
+    int count = image.cols * image.channels();
+    switch (image.depth()) {
+        case CV_8U: {
+            const uchar* src = image.ptr<uchar>(row);
+            for (int i = 0; i < count; ++i) {
+                dst[i] = src[i] * (1.0f / 255.0f);
+            }
+            break;
+        }
+        case CV_16U: {
+            const uint16_t* src = image.ptr<uint16_t>(row);
+            for (int i = 0; i < count; ++i) {
+                dst[i] = src[i] * (1.0f / 65535.0f);
+            }
+            break;
+        }
+        case CV_16F:
+            pixelKernels().halfToFloatRow(image.ptr<uint16_t>(row), dst, count);
+            break;
+        case CV_32F:
+            std::memcpy(dst, image.ptr<float>(row), count * sizeof(float));
+            break;
+        default:
+            CV_Error(cv::Error::StsUnsupportedFormat, "loadRow: unsupported depth");
+    }
+}
+
+void storeRow8U(const float* src, uchar* dst, int count) {
+    for (int i = 0; i < count; ++i) {
+        dst[i] = cv::saturate_cast<uchar>(src[i] * 255.0f);
+    }
+}
@@ -0,0 +1,26 @@
+#ifndef PIXEL_PRECISION_H
+#define PIXEL_PRECISION_H
+
+#include <opencv2/opencv.hpp>
+#include <string>
+
+// Storage format for frame-sized intermediates of the float-based stages. Math always runs in FP32;
+// FLOAT16 keeps half floats (CV_16F) and FIXED16 keeps unorm16 (CV_16U, 1.0 == 65535).
+enum class IntermediatePrecision {
+    FLOAT32,
+    FLOAT16,
+    FIXED16
+};
+
+const char* precisionName(IntermediatePrecision precision);
+bool parsePrecision(const std::string& text, IntermediatePrecision& precision);
+int precisionBytes(IntermediatePrecision precision);
+
+// Converts an 8-bit image into working storage holding values in [0, 1]
+cv::Mat toWorkingStorage(const cv::Mat& src, IntermediatePrecision precision);
+
+// Unpacks one row (cols * channels samples) of a CV_8U, CV_16U, CV_16F or CV_32F image into [0, 1] floats
+void loadRow(const cv::Mat& image, int row, float* dst);
+void storeRow8U(const float* src, uchar* dst, int count);
+
+#endif
@@ -0,0 +1,216 @@
+#include "ProgressiveRenderer.h"
+#include <algorithm>
+
+ProgressiveRenderer::ProgressiveRenderer(const FilterManager& filters, const OverlayManager& overlays,
+                                         const TiledExecutor& executor)
+    : filterManager(filters), overlayManager(overlays), tiledExecutor(executor) {}
+
+ProgressiveRenderer::~ProgressiveRenderer() {
+    stop();
+}
+
+void ProgressiveRenderer::setPreviewScale(double scale) {
+    std::lock_guard<std::mutex> lock(mutex);
+    previewScale = std::min(1.0, std::max(0.1, scale));
+}
+
+double ProgressiveRenderer::getPreviewScale() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return previewScale;
+}
+
+void ProgressiveRenderer::setSyncBudget(double milliseconds) {
+    std::lock_guard<std::mutex> lock(mutex);
+    syncBudgetMs = std::max(0.0, milliseconds);
+}
+
+// The edit alone; a request is the edit on a source frame. The face mask and history are derived
+// from the source frame, so sourceId already covers them
+uint64_t ProgressiveRenderer::editKey(const ChainSpec& spec) {
+    uint64_t key = hashCombine(static_cast<uint64_t>(spec.filter), static_cast<uint64_t>(spec.overlay));
+    return hashCombine(key, FilterManager::hashParams(spec.params));
+}
+
+// Called with the mutex held
+void ProgressiveRenderer::cancelJobs() {
+    if (inFlight) {
+        inFlight->store(true);
+        inFlight.reset();
+    }
+    if (hasPending) {
+        pending.cancelled->store(true);
+        hasPending = false;
+    }
+}
+
+// Called with the mutex held; replaces a job that has not started yet
+void ProgressiveRenderer::queue(const cv::Mat& input, const ChainSpec& spec, bool tiled, uint64_t key, uint64_t edit) {
+    pending.input = input;
+    pending.spec = spec;
+    pending.tiled = tiled;
+    pending.key = key;
+    pending.edit = edit;
+    pending.cancelled = std::make_shared<std::atomic<bool>>(false);
+    hasPending = true;
+    if (!running) {
+        running = true;
+        worker = std::thread(&ProgressiveRenderer::workerLoop, this);
+    }
+    wake.notify_one();
+}
+
+cv::Mat ProgressiveRenderer::render(const cv::Mat& input, uint64_t sourceId, const ChainSpec& spec, bool tiled, bool full) {
+    if (input.empty()) {
+        return input;
+    }
+    uint64_t edit = editKey(spec);
+    uint64_t key = hashCombine(sourceId, edit);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    bool ready = hasKey && key == currentKey && refinedKey == key && !refined.empty();
+    if (ready || (hasKey && key == currentKey && !full)) {
+        // refined only ever holds a result of the current edit, possibly of an older frame
+        return !refined.empty() ? refined : preview;
+    }
+
+    auto cost = fullCost.find(spec.filter);
+    bool synchronous = full || spec.filter == FilterType::NONE || (cost != fullCost.end() && cost->second <= syncBudgetMs);
+
+    // New frame, same edit: the refinement in flight finishes and stays on screen until this one lands
+    if (!synchronous && hasKey && edit == currentEdit && !refined.empty()) {
+        currentKey = key;
+        queue(input, spec, tiled, key, edit);
+        return refined;
+    }
+
+    // New edit: whatever is queued or running is stale now
+    cancelJobs();
+    currentKey = key;
+    currentEdit = edit;
+    hasKey = true;
+    refined.release();
+    preview.release();
+    double scale = previewScale;
+    lock.unlock();
+
+    if (synchronous) {
+        int64 start = cv::getTickCount();
+        cv::Mat output = renderFull(input, spec, tiled);
+        double ms = (cv::getTickCount() - start) * 1000.0 / cv::getTickFrequency();
+        lock.lock();
+        fullCost[spec.filter] = ms;
+        if (currentKey == key) {
+            refined = output;
+            refinedKey = key;
+        }
+        return output;
+    }
+
+    cv::Mat low = scale < 1.0 ? renderPreview(input, spec) : input;
+
+    lock.lock();
+    if (currentKey != key) {
+        return low;
+    }
+    preview = low;
+    queue(input, spec, tiled, key, edit);
+    return low;
+}
+
+bool ProgressiveRenderer::isRefining() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hasPending || refining;
+}
+
+void ProgressiveRenderer::cancel() {
+    std::lock_guard<std::mutex> lock(mutex);
+    cancelJobs();
+    hasKey = false;
+    preview.release();
+    refined.release();
+}
+
+void ProgressiveRenderer::stop() {
+    cancel();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    wake.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+// Filters a downscaled copy and scales the result back up; neighbourhood sizes shrink with the
+// image so blurs look alike, and the overlay is blended at full size because it is screen-aligned
+cv::Mat ProgressiveRenderer::renderPreview(const cv::Mat& input, const ChainSpec& spec) const {
+    cv::Mat output;
+    if (spec.filter != FilterType::NONE) {
+        output = filterManager.applyFilterAtScale(input, spec.filter, spec.params, getPreviewScale());
+    } else {
+        output = input;
+    }
+    if (spec.overlay != OverlayType::NONE) {
+        if (output.channels() == 1) {
+            cv::cvtColor(output, output, cv::COLOR_GRAY2BGR);
+        }
+        output = overlayManager.apply(output, spec.overlay);
+    }
+    return output;
+}
+
+cv::Mat ProgressiveRenderer::renderFull(const cv::Mat& input, const ChainSpec& spec, bool tiled) const {
+    if (tiled) {
+        return tiledExecutor.run(input, spec);
+    }
+    cv::Mat output = spec.filter != FilterType::NONE ? filterManager.applyFilter(input, spec.filter, spec.params) : input;
+    if (spec.cancel && spec.cancel->load()) {
+        return output;
+    }
+    if (spec.overlay != OverlayType::NONE) {
+        if (output.channels() == 1) {
+            cv::cvtColor(output, output, cv::COLOR_GRAY2BGR);
+        }
+        output = overlayManager.apply(output, spec.overlay);
+    }
+    return output;
+}
+
+void ProgressiveRenderer::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (running) {
+        wake.wait(lock, [this] { return !running || hasPending; });
+        if (!running) {
+            break;
+        }
+        Job job = std::move(pending);
+        hasPending = false;
+        refining = true;
+        inFlight = job.cancelled;
+        lock.unlock();
+
+        job.spec.cancel = job.cancelled.get();
+        int64 start = cv::getTickCount();
+        cv::Mat output = renderFull(job.input, job.spec, job.tiled);
+        double ms = (cv::getTickCount() - start) * 1000.0 / cv::getTickFrequency();
+
+        lock.lock();
+        refining = false;
+        if (inFlight == job.cancelled) {
+            inFlight.reset();
+        }
+        if (job.cancelled->load()) {
+            continue;
+        }
+        fullCost[job.spec.filter] = ms;
+        // An older frame of the current edit is still better than the preview
+        if (hasKey && job.edit == currentEdit) {
+            refined = output;
+            refinedKey = job.key;
+            if (job.key == currentKey) {
+                preview.release();
+            }
+        }
+    }
+}
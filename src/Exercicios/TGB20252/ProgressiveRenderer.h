@@ -0,0 +1,82 @@
+#ifndef PROGRESSIVE_RENDERER_H
+#define PROGRESSIVE_RENDERER_H
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "TiledExecutor.h"
+
+// Low-resolution-first rendering of the filter + overlay stages for PHOTO mode edits.
+// A new edit is answered at once with a preview filtered at reduced scale and upscaled, while the
+// full-resolution result is computed on a worker thread and swapped in when it lands. Starting
+// another edit cancels the refinement in flight between strips. A new source frame under the same
+// edit never drops back to the preview: the last full-resolution result stays up while the newest
+// frame is refined behind it.
+class ProgressiveRenderer {
+public:
+    ProgressiveRenderer(const FilterManager& filters, const OverlayManager& overlays, const TiledExecutor& executor);
+    ~ProgressiveRenderer();
+
+    // Linear scale of the preview; 0.5 filters a quarter of the pixels
+    void setPreviewScale(double scale);
+    double getPreviewScale() const;
+    // Filters whose last full-resolution run fit in this budget are rendered synchronously
+    void setSyncBudget(double milliseconds);
+
+    // sourceId identifies the input pixels; spec must only carry the filter, its params and the overlay.
+    // With full set the full-resolution result is produced on this thread if it is not ready (captures)
+    cv::Mat render(const cv::Mat& input, uint64_t sourceId, const ChainSpec& spec, bool tiled, bool full = false);
+    bool isRefining() const;
+    void cancel();
+    void stop();
+
+private:
+    struct Job {
+        cv::Mat input;
+        ChainSpec spec;
+        bool tiled{false};
+        uint64_t key{0};
+        uint64_t edit{0};
+        std::shared_ptr<std::atomic<bool>> cancelled;
+    };
+
+    const FilterManager& filterManager;
+    const OverlayManager& overlayManager;
+    const TiledExecutor& tiledExecutor;
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::thread worker;
+    bool running{false};
+
+    Job pending;
+    bool hasPending{false};
+    std::shared_ptr<std::atomic<bool>> inFlight;
+    bool refining{false};
+
+    uint64_t currentKey{0};
+    uint64_t currentEdit{0};
+    bool hasKey{false};
+    cv::Mat preview;
+    cv::Mat refined;
+    uint64_t refinedKey{0};
+    std::map<FilterType, double> fullCost;
+
+    double previewScale{0.5};
+    double syncBudgetMs{8.0};
+
+    static uint64_t editKey(const ChainSpec& spec);
+    void cancelJobs();
+    void queue(const cv::Mat& input, const ChainSpec& spec, bool tiled, uint64_t key, uint64_t edit);
+    cv::Mat renderPreview(const cv::Mat& input, const ChainSpec& spec) const;
+    cv::Mat renderFull(const cv::Mat& input, const ChainSpec& spec, bool tiled) const;
+    void workerLoop();
+};
+
+#endif
@@ -0,0 +1,260 @@
+#include "RetroCapture.h"
+#include "OptionParsing.h"
+#include "VideoRecorder.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+namespace {
+const int kJpegQuality = 90;
+// Frames waiting for compression; anything beyond this is dropped instead of queued
+const int kMaxPending = 3;
+// Typical size of a 540x960 frame at quality 90, reserved up front so the ring rarely reallocates
+const size_t kSlotReserve = 160 * 1024;
+}
+
+bool parseRetroOptions(const std::string& text, double& seconds, RetroFormat& format) {
+    std::string value = text.substr(0, text.find(':'));
+    std::string name = text.find(':') == std::string::npos ? "" : text.substr(text.find(':') + 1);
+    if (!parseNumberOption(value, 0.0, false, seconds)) {
+        return false;
+    }
+    if (name == "burst") {
+        format = RetroFormat::BURST;
+    } else if (name == "gif") {
+        format = RetroFormat::GIF;
+    } else if (name == "webp") {
+        format = RetroFormat::WEBP;
+    } else if (name == "clip" || name.empty()) {
+        format = RetroFormat::CLIP;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+RetroCapture::RetroCapture() {}
+
+RetroCapture::~RetroCapture() {
+    stop();
+}
+
+void RetroCapture::configure(double windowSeconds, double sourceFps) {
+    std::lock_guard<std::mutex> lock(mutex);
+    seconds = std::max(0.0, windowSeconds);
+    fps = sourceFps > 1.0 ? sourceFps : 30.0;
+    int capacity = static_cast<int>(seconds * fps + 0.5);
+    slots.assign(capacity, Slot());
+    head = count = 0;
+    pending.clear();
+}
+
+double RetroCapture::getSeconds() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return seconds;
+}
+
+void RetroCapture::setAnimationOptions(const AnimationOptions& options) {
+    std::lock_guard<std::mutex> lock(mutex);
+    animationOptions = options;
+}
+
+void RetroCapture::push(const cv::Mat& frame, double timestamp, PixelLayout layout) {
+    if (frame.empty()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (slots.empty()) {
+            return;
+        }
+        if (static_cast<int>(pending.size()) >= kMaxPending) {
+            ++droppedFrames;
+            return;
+        }
+        pending.push_back({frame, timestamp, layout});
+        if (!running) {
+            running = true;
+            compressor = std::thread(&RetroCapture::compressLoop, this);
+        }
+    }
+    wake.notify_one();
+}
+
+void RetroCapture::compressLoop() {
+    const std::vector<int> params = {cv::IMWRITE_JPEG_QUALITY, kJpegQuality};
+    auto encoded = std::make_shared<std::vector<uchar>>();
+    encoded->reserve(kSlotReserve);
+    cv::Mat bgr;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return !running || !pending.empty(); });
+        if (!running) {
+            break;
+        }
+        Pending job = std::move(pending.front());
+        pending.pop_front();
+        lock.unlock();
+
+        bool ok = false;
+        try {
+            convertToBgr(job.frame, job.layout, bgr);
+            ok = cv::imencode(".jpg", bgr, *encoded, params);
+        } catch (const cv::Exception& e) {
+            std::cerr << "Retro capture error: " << e.what() << std::endl;
+        }
+        job.frame.release();
+        if (job.layout == PixelLayout::BGR) {
+            bgr.release();
+        }
+
+        lock.lock();
+        if (ok && !slots.empty()) {
+            // The overwritten buffer becomes the next encode target unless a save still holds it, so
+            // the ring stops allocating once it has wrapped
+            Slot& slot = slots[head];
+            std::shared_ptr<const std::vector<uchar>> previous = std::move(slot.jpeg);
+            slot.jpeg = std::move(encoded);
+            slot.timestamp = job.timestamp;
+            if (previous && previous.use_count() == 1) {
+                encoded = std::const_pointer_cast<std::vector<uchar>>(previous);
+            } else {
+                encoded = std::make_shared<std::vector<uchar>>();
+                encoded->reserve(kSlotReserve);
+            }
+            head = (head + 1) % static_cast<int>(slots.size());
+            count = std::min(count + 1, static_cast<int>(slots.size()));
+        }
+    }
+}
+
+bool RetroCapture::save(const std::string& basePath, RetroFormat format) {
+    std::vector<Slot> window;
+    double clipFps = 30.0;
+    AnimationOptions animation;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (saving || count == 0) {
+            return false;
+        }
+        // Oldest first; only the buffer pointers are copied, and the ring keeps filling meanwhile
+        int capacity = static_cast<int>(slots.size());
+        window.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            window.push_back(slots[(head - count + i + capacity) % capacity]);
+        }
+        clipFps = fps;
+        animation = animationOptions;
+        saving = true;
+    }
+    if (saver.joinable()) {
+        saver.join();
+    }
+    saver = std::thread(&RetroCapture::saveWindow, this, std::move(window), basePath, format, clipFps, animation);
+    return true;
+}
+
+void RetroCapture::saveWindow(std::vector<Slot> window, std::string basePath, RetroFormat format, double clipFps,
+                              AnimationOptions animation) {
+    int written = 0;
+    std::string target = basePath;
+    if (format == RetroFormat::GIF || format == RetroFormat::WEBP) {
+        // Frames are decoded on demand by the exporter's worker threads, straight from the copied JPEGs
+        animation.format = format == RetroFormat::GIF ? AnimationFormat::GIF : AnimationFormat::WEBP;
+        target += format == RetroFormat::GIF ? ".gif" : ".webp";
+        auto frameAt = [&window](int i) { return cv::imdecode(*window[i].jpeg, cv::IMREAD_COLOR); };
+        if (exportAnimation(target, static_cast<int>(window.size()), frameAt, clipFps, animation)) {
+            written = static_cast<int>(window.size());
+        }
+    } else if (format == RetroFormat::BURST) {
+        for (const auto& slot : window) {
+            char index[8];
+            snprintf(index, sizeof(index), "%04d", written);
+            std::ofstream file(basePath + "_" + index + ".jpg", std::ios::binary);
+            file.write(reinterpret_cast<const char*>(slot.jpeg->data()), slot.jpeg->size());
+            if (file) {
+                ++written;
+            }
+        }
+        target += "_*.jpg";
+    } else {
+        cv::VideoWriter writer;
+        for (const auto& slot : window) {
+            cv::Mat frame = cv::imdecode(*slot.jpeg, cv::IMREAD_COLOR);
+            if (frame.empty()) {
+                continue;
+            }
+            if (!writer.isOpened() && !openVideoWriter(writer, basePath, clipFps, frame.size(), target)) {
+                break;
+            }
+            try {
+                writer.write(frame);
+                ++written;
+            } catch (const cv::Exception& e) {
+                std::cerr << "Retro capture error: " << e.what() << std::endl;
+                break;
+            }
+        }
+        writer.release();
+    }
+
+    double covered = window.empty() ? 0.0 : window.back().timestamp - window.front().timestamp;
+    std::cout << "Saved last " << covered << " s: " << target << " (" << written << " frames)" << std::endl;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    saving = false;
+}
+
+bool RetroCapture::isSaving() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return saving;
+}
+
+int RetroCapture::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return count;
+}
+
+double RetroCapture::span() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (count < 2) {
+        return 0.0;
+    }
+    int capacity = static_cast<int>(slots.size());
+    const Slot& newest = slots[(head - 1 + capacity) % capacity];
+    const Slot& oldest = slots[(head - count + capacity) % capacity];
+    return newest.timestamp - oldest.timestamp;
+}
+
+size_t RetroCapture::memoryBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t total = 0;
+    for (const auto& slot : slots) {
+        total += slot.jpeg ? slot.jpeg->capacity() : 0;
+    }
+    return total;
+}
+
+int RetroCapture::dropped() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return droppedFrames;
+}
+
+// Lets a save in progress finish so the last clip is not truncated
+void RetroCapture::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+        pending.clear();
+    }
+    wake.notify_all();
+    if (compressor.joinable()) {
+        compressor.join();
+    }
+    if (saver.joinable()) {
+        saver.join();
+    }
+}
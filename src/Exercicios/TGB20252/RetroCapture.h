@@ -0,0 +1,87 @@
+#ifndef RETRO_CAPTURE_H
+#define RETRO_CAPTURE_H
+
+#include <opencv2/opencv.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AnimationExporter.h"
+#include "FrameSource.h"
+
+enum class RetroFormat {
+    CLIP,   // one video file at the source FPS
+    BURST,  // one JPEG per frame, written as stored without re-encoding
+    GIF,    // looping animations through AnimationExporter
+    WEBP
+};
+
+// Parses "seconds[:clip|burst|gif|webp]"; 0 seconds disables the buffer
+bool parseRetroOptions(const std::string& text, double& seconds, RetroFormat& format);
+
+// Keeps the last few seconds of processed frames so a moment can be saved after it happened.
+// Frames are JPEG-compressed on a worker thread into a fixed number of slots whose byte buffers
+// are reused, so memory stays at roughly a tenth of the raw frames and push() never waits: while
+// the compressor is busy, extra frames are dropped and counted. Slots share their buffers, so a
+// save only copies pointers; a buffer a save still holds is not reused until it lets go.
+class RetroCapture {
+public:
+    RetroCapture();
+    ~RetroCapture();
+
+    // Discards buffered frames and sizes the ring for seconds * fps frames
+    void configure(double seconds, double fps);
+    double getSeconds() const;
+    void setAnimationOptions(const AnimationOptions& options);
+
+    // frame must not be written afterwards. Planar frames (I420/NV12) are converted to BGR on the
+    // compressor thread, so the planar display path can keep feeding the ring
+    void push(const cv::Mat& frame, double timestamp, PixelLayout layout = PixelLayout::BGR);
+
+    // Takes the current window and writes it in the background; false if empty or still saving
+    bool save(const std::string& basePath, RetroFormat format);
+    bool isSaving() const;
+
+    int size() const;
+    double span() const;
+    size_t memoryBytes() const;
+    int dropped() const;
+    void stop();
+
+private:
+    struct Slot {
+        std::shared_ptr<const std::vector<uchar>> jpeg;
+        double timestamp{0.0};
+    };
+    struct Pending {
+        cv::Mat frame;
+        double timestamp{0.0};
+        PixelLayout layout{PixelLayout::BGR};
+    };
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::thread compressor;
+    std::thread saver;
+    std::deque<Pending> pending;
+    std::vector<Slot> slots;
+    int head{0};
+    int count{0};
+    double seconds{0.0};
+    double fps{30.0};
+    AnimationOptions animationOptions;
+    int droppedFrames{0};
+    bool running{false};
+    bool saving{false};
+
+    void compressLoop();
+    void saveWindow(std::vector<Slot> window, std::string basePath, RetroFormat format, double clipFps,
+                    AnimationOptions animation);
+};
+
+#endif
@@ -0,0 +1,207 @@
+#include "ScopeAnalyzer.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace {
+const int kMaxStride = 16;
+
+// Fills a 256-row waveform image from per-column counts; brighter means more samples at that level
+void renderWaveform(const std::vector<uint16_t>& counts, int columns, int rows, cv::Mat& image, int channel, int offset) {
+    float gain = 255.0f * 16.0f / std::max(1, rows);
+    for (int level = 0; level < 256; ++level) {
+        uchar* out = image.ptr<uchar>(255 - level);
+        const uint16_t* row = counts.data() + level * columns;
+        for (int x = 0; x < columns; ++x) {
+            uchar value = static_cast<uchar>(std::min(255.0f, row[x] * gain));
+            if (channel < 0) {
+                out[offset + x] = value;
+            } else {
+                out[(offset + x) * 3 + channel] = value;
+            }
+        }
+    }
+}
+
+void normalizeHistogram(const uint32_t (&lanes)[4][256], std::array<float, 256>& out) {
+    uint32_t peak = 1;
+    uint32_t merged[256];
+    for (int bin = 0; bin < 256; ++bin) {
+        merged[bin] = lanes[0][bin] + lanes[1][bin] + lanes[2][bin] + lanes[3][bin];
+        peak = std::max(peak, merged[bin]);
+    }
+    for (int bin = 0; bin < 256; ++bin) {
+        out[bin] = static_cast<float>(merged[bin]) / peak;
+    }
+}
+}
+
+ScopeAnalyzer::ScopeAnalyzer() {}
+
+ScopeAnalyzer::~ScopeAnalyzer() {
+    stop();
+}
+
+void ScopeAnalyzer::start() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (running) {
+        return;
+    }
+    running = true;
+    worker = std::thread(&ScopeAnalyzer::workerLoop, this);
+}
+
+void ScopeAnalyzer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+        pending.release();
+    }
+    wake.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+bool ScopeAnalyzer::isRunning() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return running;
+}
+
+void ScopeAnalyzer::setBudget(double milliseconds) {
+    std::lock_guard<std::mutex> lock(mutex);
+    budgetMs = std::max(0.1, milliseconds);
+}
+
+double ScopeAnalyzer::getBudget() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return budgetMs;
+}
+
+void ScopeAnalyzer::submit(const cv::Mat& frame) {
+    if (frame.empty()) {
+        return;
+    }
+    int step;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running) {
+            return;
+        }
+        step = stride;
+    }
+
+    cv::Mat sample;
+    cv::resize(frame, sample, cv::Size(std::max(1, frame.cols / step), std::max(1, frame.rows / step)), 0.0, 0.0,
+               cv::INTER_NEAREST);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending = sample;
+        pendingId = ++submitted;
+    }
+    wake.notify_one();
+}
+
+bool ScopeAnalyzer::latest(ScopeData& out) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!fresh) {
+        return false;
+    }
+    out = result;
+    fresh = false;
+    return true;
+}
+
+void ScopeAnalyzer::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (running) {
+        wake.wait(lock, [this] { return !running || !pending.empty(); });
+        if (!running) {
+            break;
+        }
+        cv::Mat sample = pending;
+        pending.release();
+        uint64_t id = pendingId;
+        int usedStride = stride;
+        lock.unlock();
+
+        ScopeData data;
+        int64 start = cv::getTickCount();
+        analyze(sample, data);
+        double ms = (cv::getTickCount() - start) * 1000.0 / cv::getTickFrequency();
+
+        lock.lock();
+        data.frameId = id;
+        data.computeMs = ms;
+        data.stride = usedStride;
+        result = std::move(data);
+        fresh = true;
+        if (ms > budgetMs && stride < kMaxStride) {
+            ++stride;
+        } else if (ms < budgetMs * 0.4 && stride > 1) {
+            --stride;
+        }
+    }
+}
+
+void ScopeAnalyzer::analyze(const cv::Mat& sample, ScopeData& data) {
+    const int columns = sample.cols;
+    const int rows = sample.rows;
+    const bool color = sample.channels() >= 3;
+    const int channels = sample.channels();
+
+    // Four interleaved sub-histograms per channel: consecutive pixels usually land in the same bin, and
+    // spreading them over lanes breaks the load-increment-store dependency so the increments pipeline
+    static thread_local uint32_t histograms[4][4][256];
+    std::memset(histograms, 0, sizeof(histograms));
+    std::vector<uint16_t> lumaWave(256 * columns, 0);
+    std::vector<uint16_t> paradeWave[3];
+    for (auto& wave : paradeWave) {
+        wave.assign(color ? 256 * columns : 0, 0);
+    }
+
+    for (int y = 0; y < rows; ++y) {
+        const uchar* row = sample.ptr<uchar>(y);
+        for (int x = 0; x < columns; ++x) {
+            const uchar* px = row + x * channels;
+            int lane = x & 3;
+            int b = px[0];
+            int g = color ? px[1] : b;
+            int r = color ? px[2] : b;
+            int luma = color ? (29 * b + 150 * g + 77 * r + 128) >> 8 : b;
+            ++histograms[0][lane][luma];
+            ++histograms[1][lane][b];
+            ++histograms[2][lane][g];
+            ++histograms[3][lane][r];
+            ++lumaWave[luma * columns + x];
+            if (color) {
+                ++paradeWave[0][r * columns + x];
+                ++paradeWave[1][g * columns + x];
+                ++paradeWave[2][b * columns + x];
+            }
+        }
+    }
+
+    normalizeHistogram(histograms[0], data.luma);
+    normalizeHistogram(histograms[1], data.blue);
+    normalizeHistogram(histograms[2], data.green);
+    normalizeHistogram(histograms[3], data.red);
+
+    data.waveform = cv::Mat::zeros(256, columns, CV_8UC1);
+    renderWaveform(lumaWave, columns, rows, data.waveform, -1, 0);
+
+    data.parade = cv::Mat::zeros(256, columns * 3, CV_8UC3);
+    if (color) {
+        // R, G and B sections, each drawn in its own colour (BGR channel index 2, 1, 0)
+        renderWaveform(paradeWave[0], columns, rows, data.parade, 2, 0);
+        renderWaveform(paradeWave[1], columns, rows, data.parade, 1, columns);
+        renderWaveform(paradeWave[2], columns, rows, data.parade, 0, columns * 2);
+    } else {
+        for (int section = 0; section < 3; ++section) {
+            for (int channel = 0; channel < 3; ++channel) {
+                renderWaveform(lumaWave, columns, rows, data.parade, channel, columns * section);
+            }
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef SCOPE_ANALYZER_H
+#define SCOPE_ANALYZER_H
+
+#include <opencv2/opencv.hpp>
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+struct ScopeData {
+    std::array<float, 256> luma{};
+    std::array<float, 256> red{};
+    std::array<float, 256> green{};
+    std::array<float, 256> blue{};
+    cv::Mat waveform;   // CV_8UC1, 256 rows (white at the top) x sampled columns
+    cv::Mat parade;     // CV_8UC3, R | G | B waveforms side by side
+    uint64_t frameId{0};
+    double computeMs{0.0};
+    int stride{1};
+};
+
+// Histogram, waveform and RGB parade of the processed frame, computed on a background thread.
+// The UI thread only pays for a subsampled copy; the sampling stride adapts so the worker stays
+// within the per-frame budget, and frames that arrive while it is busy replace the pending one.
+class ScopeAnalyzer {
+public:
+    ScopeAnalyzer();
+    ~ScopeAnalyzer();
+
+    void start();
+    void stop();
+    bool isRunning() const;
+
+    void setBudget(double milliseconds);
+    double getBudget() const;
+
+    void submit(const cv::Mat& frame);
+    // Copies the newest results into out; returns false when nothing changed since the last call
+    bool latest(ScopeData& out);
+
+private:
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::thread worker;
+    bool running{false};
+
+    cv::Mat pending;
+    uint64_t submitted{0};
+    uint64_t pendingId{0};
+    ScopeData result;
+    bool fresh{false};
+    double budgetMs{2.0};
+    int stride{4};
+
+    void workerLoop();
+    static void analyze(const cv::Mat& sample, ScopeData& data);
+};
+
+#endif
@@ -1,4 +1,7 @@
 #include "StickerManager.h"
+#include "PixelKernels.h"
+#include <algorithm>
+#include <cmath>
 
 StickerManager::StickerManager() : defaultScale(0.15f), nextId(0) {}
 
@@ -53,18 +56,24 @@ void StickerManager::addSticker(int stickerIndex, cv::Point position) {
     sticker.position = position;
     sticker.scale = 1.0f;
     sticker.id = nextId++;
+    sticker.templateIndex = stickerIndex;
     sticker.active = true;
     
     activeStickers.push_back(sticker);
+    ++editRevision;
 }
 
 void StickerManager::removeSticker(int index) {
     if (index >= 0 && index < (int)activeStickers.size()) {
         activeStickers.erase(activeStickers.begin() + index);
+        ++editRevision;
     }
 }
 
 void StickerManager::clearStickers() {
+    if (!activeStickers.empty()) {
+        ++editRevision;
+    }
     activeStickers.clear();
 }
 
@@ -72,13 +81,7 @@ cv::Mat StickerManager::applyStickers(const cv::Mat& baseImage) {
     if (baseImage.empty()) return baseImage;
     
     cv::Mat result = baseImage.clone();
-    
-    for (const auto& sticker : activeStickers) {
-        if (sticker.active && !sticker.image.empty()) {
-            result = overlayImage(result, sticker.image, sticker.position);
-        }
-    }
-    
+    applyStickersInPlace(result, cv::Point(0, 0));
     return result;
 }
 
@@ -86,6 +89,10 @@ int StickerManager::getStickerCount() const {
     return activeStickers.size();
 }
 
+int StickerManager::revision() const {
+    return editRevision;
+}
+
 const std::vector<cv::Mat>& StickerManager::getAvailableStickers() const {
     return availableStickers;
 }
@@ -96,42 +103,84 @@ void StickerManager::setScale(float scale) {
 
 cv::Mat StickerManager::overlayImage(const cv::Mat& background, const cv::Mat& foreground, cv::Point position, float alpha) const {
     cv::Mat result = background.clone();
-    
-    if (foreground.channels() != 4) {
-        return result;
+    blendSticker(result, foreground, cv::Point(position.x - foreground.cols / 2, position.y - foreground.rows / 2), alpha);
+    return result;
+}
+
+void StickerManager::blendSticker(cv::Mat& target, const cv::Mat& foreground, cv::Point topLeft, float alpha) const {
+    if (foreground.channels() != 4 || target.type() != CV_8UC3) {
+        return;
     }
     
-    int x = position.x - foreground.cols / 2;
-    int y = position.y - foreground.rows / 2;
+    int firstRow = std::max(0, -topLeft.y);
+    int lastRow = std::min(foreground.rows, target.rows - topLeft.y);
+    int firstCol = std::max(0, -topLeft.x);
+    int lastCol = std::min(foreground.cols, target.cols - topLeft.x);
+    if (firstCol >= lastCol) {
+        return;
+    }
     
-    for (int i = 0; i < foreground.rows; i++) {
-        int bgY = y + i;
-        if (bgY < 0 || bgY >= background.rows) continue;
-        
-        for (int j = 0; j < foreground.cols; j++) {
-            int bgX = x + j;
-            if (bgX < 0 || bgX >= background.cols) continue;
-            
-            cv::Vec4b fgPixel = foreground.at<cv::Vec4b>(i, j);
-            float fgAlpha = (fgPixel[3] / 255.0f) * alpha;
-            
-            if (fgAlpha > 0) {
-                cv::Vec3b& bgPixel = result.at<cv::Vec3b>(bgY, bgX);
-                
-                bgPixel[0] = cv::saturate_cast<uchar>((1.0f - fgAlpha) * bgPixel[0] + fgAlpha * fgPixel[0]);
-                bgPixel[1] = cv::saturate_cast<uchar>((1.0f - fgAlpha) * bgPixel[1] + fgAlpha * fgPixel[1]);
-                bgPixel[2] = cv::saturate_cast<uchar>((1.0f - fgAlpha) * bgPixel[2] + fgAlpha * fgPixel[2]);
-            }
+    const PixelKernels& kernels = pixelKernels();
+    for (int i = firstRow; i < lastRow; i++) {
+        const uchar* fgRow = foreground.ptr<uchar>(i) + firstCol * 4;
+        uchar* bgRow = target.ptr<uchar>(topLeft.y + i) + (topLeft.x + firstCol) * 3;
+        kernels.blendBgraOverBgr(bgRow, fgRow, lastCol - firstCol, alpha);
+    }
+}
+
+void StickerManager::applyStickersInPlace(cv::Mat& region, cv::Point origin) const {
+    for (const auto& sticker : activeStickers) {
+        if (sticker.active && !sticker.image.empty()) {
+            cv::Point topLeft(sticker.position.x - sticker.image.cols / 2 - origin.x,
+                              sticker.position.y - sticker.image.rows / 2 - origin.y);
+            blendSticker(region, sticker.image, topLeft, 1.0f);
         }
     }
+}
+
+void StickerManager::renderPreviewInPlace(cv::Mat& region, cv::Point origin, int stickerIndex, cv::Point position, float alpha) const {
+    if (stickerIndex < 0 || stickerIndex >= (int)availableStickers.size()) {
+        return;
+    }
     
+    const cv::Mat& stickerTemplate = availableStickers[stickerIndex];
+    cv::Point topLeft(position.x - stickerTemplate.cols / 2 - origin.x, position.y - stickerTemplate.rows / 2 - origin.y);
+    blendSticker(region, stickerTemplate, topLeft, alpha);
+}
+
+std::vector<StickerPlacement> StickerManager::placements() const {
+    std::vector<StickerPlacement> result;
+    for (const auto& sticker : activeStickers) {
+        if (sticker.active) {
+            result.push_back({sticker.templateIndex, sticker.position});
+        }
+    }
     return result;
 }
 
+void StickerManager::applyPlacements(cv::Mat& target, const std::vector<StickerPlacement>& placements, double scale) const {
+    for (const auto& placement : placements) {
+        if (placement.sticker < 0 || placement.sticker >= (int)availableStickers.size()) {
+            continue;
+        }
+        const cv::Mat& stickerTemplate = availableStickers[placement.sticker];
+        cv::Mat scaled = stickerTemplate;
+        if (std::abs(scale - 1.0) > 1e-3) {
+            int interpolation = scale > 1.0 ? cv::INTER_CUBIC : cv::INTER_AREA;
+            cv::resize(stickerTemplate, scaled, cv::Size(), scale, scale, interpolation);
+        }
+        cv::Point topLeft(placement.position.x - scaled.cols / 2, placement.position.y - scaled.rows / 2);
+        blendSticker(target, scaled, topLeft, 1.0f);
+    }
+}
+
 void StickerManager::updateStickerPosition(int stickerId, cv::Point newPosition) {
     for (auto& sticker : activeStickers) {
         if (sticker.id == stickerId) {
-            sticker.position = newPosition;
+            if (sticker.position != newPosition) {
+                sticker.position = newPosition;
+                ++editRevision;
+            }
             break;
         }
     }
@@ -10,9 +10,16 @@ struct Sticker {
     cv::Point position;
     float scale;
     int id;
+    int templateIndex;
     bool active;
 };
 
+// Where a sticker template was placed, in the coordinates of the frame it was placed on
+struct StickerPlacement {
+    int sticker;
+    cv::Point position;
+};
+
 class StickerManager {
 public:
     StickerManager();
@@ -23,6 +30,8 @@ public:
     void clearStickers();
     cv::Mat applyStickers(const cv::Mat& baseImage);
     int getStickerCount() const;
+    // Bumped whenever a sticker is added, moved or removed
+    int revision() const;
     const std::vector<cv::Mat>& getAvailableStickers() const;
     void setScale(float scale);
     
@@ -30,13 +39,23 @@ public:
     int findStickerAtPosition(cv::Point pos) const;
     cv::Mat renderPreview(const cv::Mat& baseImage, int stickerIndex, cv::Point position, float alpha = 0.5f) const;
     
+    // In-place variants for a window of the frame whose top-left corner sits at origin (used by tiled execution)
+    void applyStickersInPlace(cv::Mat& region, cv::Point origin) const;
+    void renderPreviewInPlace(cv::Mat& region, cv::Point origin, int stickerIndex, cv::Point position, float alpha = 0.5f) const;
+
+    // Placements replayed on another resolution: positions are already mapped, templates are resized by scale
+    std::vector<StickerPlacement> placements() const;
+    void applyPlacements(cv::Mat& target, const std::vector<StickerPlacement>& placements, double scale) const;
+    
 private:
     std::vector<cv::Mat> availableStickers;
     std::vector<Sticker> activeStickers;
     float defaultScale;
     int nextId;
+    int editRevision{0};
     
     cv::Mat overlayImage(const cv::Mat& background, const cv::Mat& foreground, cv::Point position, float alpha = 1.0f) const;
+    void blendSticker(cv::Mat& target, const cv::Mat& foreground, cv::Point topLeft, float alpha) const;
 };
 
 #endif
@@ -0,0 +1,164 @@
+#include "TemporalReuse.h"
+#include "FramePool.h"
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+TemporalReuse::TemporalReuse(const FilterManager& filters) : filterManager(filters) {}
+
+bool TemporalReuse::canReuse(FilterType filter) {
+    // Frame-global filters (Canny thresholds, VHS noise) change everywhere every frame, and temporal
+    // filters change wherever their history does
+    const FilterTraits& traits = filterInfo(filter).traits;
+    return filter != FilterType::NONE && !traits.frameGlobal && traits.historyFrames == 0;
+}
+
+void TemporalReuse::reset() {
+    referenceInput.release();
+    referenceMask.release();
+    cachedOutput.release();
+    refilteredFraction = 1.0;
+}
+
+void TemporalReuse::setThreshold(double meanAbsDiff) {
+    threshold = std::max(0.0, meanAbsDiff);
+}
+
+double TemporalReuse::getThreshold() const {
+    return threshold;
+}
+
+void TemporalReuse::setBlockSize(int size) {
+    blockSize = std::max(8, size);
+    reset();
+}
+
+int TemporalReuse::getBlockSize() const {
+    return blockSize;
+}
+
+double TemporalReuse::lastRefilteredFraction() const {
+    return refilteredFraction;
+}
+
+bool TemporalReuse::cacheMatches(const cv::Mat& input, FilterType filter, const FilterParams& params) const {
+    bool hasMask = params.faceMask && !params.faceMask->empty();
+    return !cachedOutput.empty() && filter == cachedFilter && input.size() == referenceInput.size() &&
+           input.type() == referenceInput.type() && hasMask == !referenceMask.empty() &&
+           params.kernelSize == cachedParams.kernelSize && params.brightnessValue == cachedParams.brightnessValue &&
+           params.contrastValue == cachedParams.contrastValue && params.enableR == cachedParams.enableR &&
+           params.enableG == cachedParams.enableG && params.enableB == cachedParams.enableB &&
+           params.precision == cachedParams.precision;
+}
+
+// Mean over each block of the largest per-channel absolute difference
+cv::Mat TemporalReuse::blockChanges(const cv::Mat& current, const cv::Mat& reference, cv::Size grid) const {
+    cv::Mat diff;
+    cv::absdiff(current, reference, diff);
+    if (diff.channels() > 1) {
+        cv::Mat perPixel;
+        cv::reduce(diff.reshape(1, static_cast<int>(diff.total())), perPixel, 1, cv::REDUCE_MAX);
+        diff = perPixel.reshape(1, current.rows);
+    }
+    cv::Mat diff32F;
+    diff.convertTo(diff32F, CV_32F);
+    cv::Mat blocks;
+    cv::resize(diff32F, blocks, grid, 0.0, 0.0, cv::INTER_AREA);
+    return blocks;
+}
+
+void TemporalReuse::refilterAll(const cv::Mat& input, FilterType filter, const FilterParams& params) {
+    cachedOutput = filterManager.applyFilter(input, filter, params);
+    referenceInput = input.clone();
+    if (params.faceMask && !params.faceMask->empty()) {
+        referenceMask = params.faceMask->clone();
+    } else {
+        referenceMask.release();
+    }
+    cachedFilter = filter;
+    cachedParams = params;
+    cachedParams.faceMask.reset();
+    refilteredFraction = 1.0;
+}
+
+cv::Mat TemporalReuse::apply(const cv::Mat& input, FilterType filter, const FilterParams& params) {
+    if (input.empty() || !canReuse(filter)) {
+        return filterManager.applyFilter(input, filter, params);
+    }
+    if (!cacheMatches(input, filter, params)) {
+        refilterAll(input, filter, params);
+        return cachedOutput;
+    }
+
+    cv::Size grid((input.cols + blockSize - 1) / blockSize, (input.rows + blockSize - 1) / blockSize);
+    cv::Mat changes = blockChanges(input, referenceInput, grid);
+    if (!referenceMask.empty()) {
+        cv::max(changes, blockChanges(*params.faceMask, referenceMask, grid), changes);
+    }
+
+    cv::Mat dirty;
+    cv::compare(changes, threshold, dirty, cv::CMP_GT);
+    int dirtyBlocks = cv::countNonZero(dirty);
+    if (dirtyBlocks == 0) {
+        refilteredFraction = 0.0;
+        return cachedOutput;
+    }
+
+    // Output blocks read input up to halo pixels away, so a changed block dirties its neighbours too
+    int halo = filterHaloRadius(filter, params.kernelSize);
+    int haloBlocks = (halo + blockSize - 1) / blockSize;
+    if (haloBlocks > 0) {
+        cv::dilate(dirty, dirty, cv::getStructuringElement(cv::MORPH_RECT, cv::Size(2 * haloBlocks + 1, 2 * haloBlocks + 1)));
+        dirtyBlocks = cv::countNonZero(dirty);
+    }
+    if (dirtyBlocks == grid.area()) {
+        refilterAll(input, filter, params);
+        return cachedOutput;
+    }
+
+    // Copy on write: earlier results may still be referenced by the frame history or an encoder
+    if (FramePool::isShared(cachedOutput)) {
+        cachedOutput = cachedOutput.clone();
+    }
+
+    // Horizontal runs of dirty blocks are filtered as one region each
+    std::vector<cv::Rect> runs;
+    for (int by = 0; by < grid.height; ++by) {
+        const uchar* row = dirty.ptr<uchar>(by);
+        for (int bx = 0; bx < grid.width; ++bx) {
+            if (!row[bx]) {
+                continue;
+            }
+            int start = bx;
+            while (bx + 1 < grid.width && row[bx + 1]) {
+                ++bx;
+            }
+            cv::Rect run(start * blockSize, by * blockSize, (bx + 1 - start) * blockSize, blockSize);
+            runs.push_back(run & cv::Rect(0, 0, input.cols, input.rows));
+        }
+    }
+
+    cv::parallel_for_(cv::Range(0, static_cast<int>(runs.size())), [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; ++i) {
+            const cv::Rect& run = runs[i];
+            cv::Rect haloRect(run.x - halo, run.y - halo, run.width + 2 * halo, run.height + 2 * halo);
+            haloRect &= cv::Rect(0, 0, input.cols, input.rows);
+
+            FilterParams local = params;
+            if (local.faceMask && local.faceMask->size() == input.size()) {
+                local.faceMask = std::make_shared<const cv::Mat>((*local.faceMask)(haloRect));
+            }
+            cv::Mat filtered = filterManager.applyFilter(input(haloRect), filter, local);
+            cv::Rect inner(run.x - haloRect.x, run.y - haloRect.y, run.width, run.height);
+            filtered(inner).copyTo(cachedOutput(run));
+
+            input(run).copyTo(referenceInput(run));
+            if (!referenceMask.empty()) {
+                (*params.faceMask)(run).copyTo(referenceMask(run));
+            }
+        }
+    });
+
+    refilteredFraction = static_cast<double>(dirtyBlocks) / grid.area();
+    return cachedOutput;
+}
@@ -0,0 +1,44 @@
+#ifndef TEMPORAL_REUSE_H
+#define TEMPORAL_REUSE_H
+
+#include <opencv2/opencv.hpp>
+
+#include "FilterManager.h"
+
+// Motion-adaptive filtering for video: the frame is split into blocks, blocks whose mean absolute
+// difference against the input they were last filtered from stays under the threshold keep their
+// cached output, and only changed blocks (grown by the filter halo) are filtered again.
+class TemporalReuse {
+public:
+    explicit TemporalReuse(const FilterManager& filters);
+
+    static bool canReuse(FilterType filter);
+
+    // The returned image shares the cache until the next call copies it on write; treat it as read-only
+    cv::Mat apply(const cv::Mat& input, FilterType filter, const FilterParams& params);
+    void reset();
+
+    void setThreshold(double meanAbsDiff);
+    double getThreshold() const;
+    void setBlockSize(int size);
+    int getBlockSize() const;
+    double lastRefilteredFraction() const;
+
+private:
+    const FilterManager& filterManager;
+    int blockSize{32};
+    double threshold{2.0};
+    double refilteredFraction{1.0};
+
+    FilterType cachedFilter{FilterType::NONE};
+    FilterParams cachedParams;
+    cv::Mat referenceInput;
+    cv::Mat referenceMask;
+    cv::Mat cachedOutput;
+
+    bool cacheMatches(const cv::Mat& input, FilterType filter, const FilterParams& params) const;
+    cv::Mat blockChanges(const cv::Mat& current, const cv::Mat& reference, cv::Size grid) const;
+    void refilterAll(const cv::Mat& input, FilterType filter, const FilterParams& params);
+};
+
+#endif
@@ -1,6 +1,6 @@
 #include "TextureManager.h"
 
-TextureManager::TextureManager() : textureID(0), width(0), height(0) {}
+TextureManager::TextureManager() : textureID(0), width(0), height(0), channels(3) {}
 
 TextureManager::~TextureManager() {
     cleanup();
@@ -9,6 +9,7 @@ TextureManager::~TextureManager() {
 void TextureManager::createTexture(int w, int h) {
     width = w;
     height = h;
+    channels = 3;
     
     if (textureID != 0) {
         glDeleteTextures(1, &textureID);
@@ -35,17 +36,42 @@ void TextureManager::updateTexture(const cv::Mat& image) {
     cv::Mat flipped;
     cv::flip(image, flipped, 0);
     
-    if (flipped.channels() == 3) {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, flipped.cols, flipped.rows, 0, GL_BGR, GL_UNSIGNED_BYTE, flipped.data);
-    } else if (flipped.channels() == 4) {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, flipped.cols, flipped.rows, 0, GL_BGRA, GL_UNSIGNED_BYTE, flipped.data);
+    GLenum format = GL_BGR;
+    GLint internalFormat = GL_RGB;
+    if (flipped.channels() == 4) {
+        format = GL_BGRA;
+        internalFormat = GL_RGBA;
     } else if (flipped.channels() == 1) {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, flipped.cols, flipped.rows, 0, GL_RED, GL_UNSIGNED_BYTE, flipped.data);
+        // Single-channel frames (edges, B&W) upload as GL_RED; the swizzle mask replicates R to RGB
+        format = GL_RED;
+        internalFormat = GL_R8;
     }
     
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (flipped.cols != width || flipped.rows != height || flipped.channels() != channels) {
+        width = flipped.cols;
+        height = flipped.rows;
+        channels = flipped.channels();
+        setSwizzle(channels);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, GL_UNSIGNED_BYTE, flipped.data);
+    } else {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, format, GL_UNSIGNED_BYTE, flipped.data);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    
     glBindTexture(GL_TEXTURE_2D, 0);
 }
 
+void TextureManager::setSwizzle(int channelCount) {
+    if (channelCount == 1) {
+        GLint swizzle[] = {GL_RED, GL_RED, GL_RED, GL_ONE};
+        glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    } else {
+        GLint swizzle[] = {GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA};
+        glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    }
+}
+
 void TextureManager::bind() {
     glBindTexture(GL_TEXTURE_2D, textureID);
 }
@@ -20,6 +20,9 @@ private:
     GLuint textureID;
     int width;
     int height;
+    int channels;
+
+    void setSwizzle(int channelCount);
 };
 
 #endif
@@ -0,0 +1,118 @@
+#include "TiledExecutor.h"
+#include <algorithm>
+#include <memory>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+namespace {
+// Buffers alive per strip row: haloed input, filter output, a gray/intermediate copy and the output row
+const int kLiveBuffersPerRow = 4;
+const int kMinStripRows = 16;
+
+std::size_t detectCacheBudget() {
+#if defined(__linux__) && defined(_SC_LEVEL2_CACHE_SIZE)
+    long l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if (l2 > 0) {
+        return static_cast<std::size_t>(l2);
+    }
+#endif
+    return 512 * 1024;
+}
+}
+
+TiledExecutor::TiledExecutor(const FilterManager& filters, const OverlayManager& overlays, const StickerManager& stickers)
+    : filterManager(filters), overlayManager(overlays), stickerManager(stickers), cacheBudget(detectCacheBudget()) {}
+
+bool TiledExecutor::canTile(FilterType filter) {
+    return !filterInfo(filter).traits.frameGlobal;
+}
+
+void TiledExecutor::setCacheBudget(std::size_t bytes) {
+    cacheBudget = std::max<std::size_t>(bytes, 64 * 1024);
+}
+
+std::size_t TiledExecutor::getCacheBudget() const {
+    return cacheBudget;
+}
+
+int TiledExecutor::stripRowsFor(const cv::Mat& input, int halo) const {
+    std::size_t rowBytes = static_cast<std::size_t>(input.cols) * input.elemSize() * kLiveBuffersPerRow;
+    int rows = static_cast<int>(cacheBudget / std::max<std::size_t>(rowBytes, 1));
+    // Wide halos are amortised over taller strips so the recomputed rows stay a small fraction
+    rows = std::max({rows, 4 * halo, kMinStripRows});
+    return std::min(rows, input.rows);
+}
+
+cv::Mat TiledExecutor::run(const cv::Mat& input, const ChainSpec& spec) const {
+    if (input.empty()) {
+        return input;
+    }
+
+    bool filtered = spec.filter != FilterType::NONE;
+    int halo = filtered ? filterHaloRadius(spec.filter, spec.params.kernelSize) : 0;
+    bool needsColor = spec.overlay != OverlayType::NONE || spec.stickers || spec.previewSticker >= 0 || spec.dimmed;
+    bool singleChannel = filtered && filterInfo(spec.filter).traits.singleChannelOutput && !needsColor;
+
+    cv::Mat output(input.size(), singleChannel ? CV_8UC1 : input.type());
+    int stripRows = stripRowsFor(input, halo);
+    int strips = (input.rows + stripRows - 1) / stripRows;
+
+    cv::parallel_for_(cv::Range(0, strips), [&](const cv::Range& range) {
+        for (int s = range.start; s < range.end; ++s) {
+            if (spec.cancel && spec.cancel->load(std::memory_order_relaxed)) {
+                return;
+            }
+            int y0 = s * stripRows;
+            int y1 = std::min(y0 + stripRows, input.rows);
+            cv::Mat dst = output.rowRange(y0, y1);
+            cv::Point origin(0, y0);
+
+            if (filtered) {
+                filterStrip(input, spec, y0, y1, halo, dst);
+            } else {
+                input.rowRange(y0, y1).copyTo(dst);
+            }
+
+            if (spec.overlay != OverlayType::NONE) {
+                overlayManager.applyInPlace(dst, spec.overlay, origin);
+            }
+            if (spec.stickers) {
+                stickerManager.applyStickersInPlace(dst, origin);
+            }
+            if (spec.previewSticker >= 0) {
+                stickerManager.renderPreviewInPlace(dst, origin, spec.previewSticker, spec.previewPosition, spec.previewAlpha);
+            }
+            if (spec.dimmed) {
+                dst.convertTo(dst, -1, 0.15);
+            }
+        }
+    });
+
+    return output;
+}
+
+void TiledExecutor::filterStrip(const cv::Mat& input, const ChainSpec& spec, int y0, int y1, int halo, cv::Mat& dst) const {
+    int top = std::max(0, y0 - halo);
+    int bottom = std::min(input.rows, y1 + halo);
+    cv::Mat source = input.rowRange(top, bottom);
+
+    FilterParams params = spec.params;
+    if (params.faceMask && params.faceMask->size() == input.size()) {
+        params.faceMask = std::make_shared<const cv::Mat>(params.faceMask->rowRange(top, bottom));
+    }
+    for (auto& frame : params.history) {
+        if (frame.size() == input.size()) {
+            frame = frame.rowRange(top, bottom);
+        }
+    }
+
+    cv::Mat filtered = filterManager.applyFilter(source, spec.filter, params);
+    cv::Mat valid = filtered.rowRange(y0 - top, y1 - top);
+    if (valid.channels() != dst.channels()) {
+        cv::cvtColor(valid, dst, cv::COLOR_GRAY2BGR);
+    } else {
+        valid.copyTo(dst);
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef TILED_EXECUTOR_H
+#define TILED_EXECUTOR_H
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <cstddef>
+
+#include "FilterManager.h"
+#include "OverlayManager.h"
+#include "StickerManager.h"
+
+// One frame worth of pipeline settings, captured before the strips are dispatched
+struct ChainSpec {
+    FilterType filter{FilterType::NONE};
+    FilterParams params;
+    OverlayType overlay{OverlayType::NONE};
+    bool stickers{false};
+    int previewSticker{-1};
+    cv::Point previewPosition;
+    float previewAlpha{0.5f};
+    bool dimmed{false};
+    // When set and raised, strips not yet started are skipped and run() returns a partial frame
+    const std::atomic<bool>* cancel{nullptr};
+};
+
+// Runs filter -> overlay -> stickers -> offline dimming strip by strip. Strips are sized to stay in L2,
+// read a halo of extra rows for neighbourhood filters and are spread across cores with parallel_for_.
+class TiledExecutor {
+public:
+    TiledExecutor(const FilterManager& filters, const OverlayManager& overlays, const StickerManager& stickers);
+
+    static bool canTile(FilterType filter);
+    cv::Mat run(const cv::Mat& input, const ChainSpec& spec) const;
+
+    void setCacheBudget(std::size_t bytes);
+    std::size_t getCacheBudget() const;
+    int stripRowsFor(const cv::Mat& input, int halo) const;
+
+private:
+    const FilterManager& filterManager;
+    const OverlayManager& overlayManager;
+    const StickerManager& stickerManager;
+    std::size_t cacheBudget;
+
+    void filterStrip(const cv::Mat& input, const ChainSpec& spec, int y0, int y1, int halo, cv::Mat& dst) const;
+};
+
+#endif
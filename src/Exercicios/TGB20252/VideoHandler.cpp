@@ -1,42 +1,85 @@
 #include "VideoHandler.h"
 #include <algorithm>
+#include <cmath>
 
 VideoHandler::VideoHandler() : playing(false), videoFPS(30.0), accumulator(0.0), frameInterval(1.0/30.0) {}
 
+// The cache's thread calls into the orienter, so it has to stop before any member goes away
 VideoHandler::~VideoHandler() {
-    if (capture.isOpened()) {
-        capture.release();
-    }
+    cache.reset();
 }
 
-bool VideoHandler::loadVideo(const std::string& path) {
-    videoPath = path;
-    capture.open(path);
+bool VideoHandler::open(const std::string& spec) {
+    cache.reset();
+    source = openFrameSource(spec);
     
-    if (!capture.isOpened()) {
+    if (!source) {
         return false;
     }
     
-    videoFPS = capture.get(cv::CAP_PROP_FPS);
-    if (videoFPS <= 0 || videoFPS > 120) {
-        videoFPS = 30.0;
-    }
+    videoFPS = source->fps();
     frameInterval = 1.0 / videoFPS;
     accumulator = 0.0;
+    playhead = 0.0;
+    shownIndex = -1;
+    currentFrame.release();
+    currentPlanar.release();
+    planarLayout = source->layout();
     
-    capture >> currentFrame;
-    
-    if (!currentFrame.empty()) {
-        cv::rotate(currentFrame, currentFrame, cv::ROTATE_90_COUNTERCLOCKWISE);
-        cv::resize(currentFrame, currentFrame, cv::Size(540, 960));
+    if (source->frameCount() > 0 && source->position() >= 0) {
+        // Decoding and the orientation warp both move to the cache's thread; planar frames are
+        // warped plane by plane and stay planar
+        PixelLayout layout = planarLayout;
+        cache.reset(new FrameCache(*source, [this, layout](const cv::Mat& decoded, CachedFrame& out) {
+            out.source = decoded;
+            if (layout == PixelLayout::BGR) {
+                orienter.apply(decoded, out.display);
+            } else {
+                orienter.applyPlanar(decoded, layout, out.planar);
+            }
+        }, cacheBudget));
+        cache->setPlayhead(0, 1);
+        CachedFrame first;
+        if (cache->waitFor(0, first, 5000)) {
+            currentFrame = first.display;
+            currentPlanar = first.planar;
+            sourceFrame = first.source;
+            shownIndex = 0;
+        }
+        return !currentFrame.empty() || !currentPlanar.empty();
     }
+
+    cv::Mat frame;
+    source->read(frame);
+    storeFrame(frame);
     
     return !currentFrame.empty();
 }
 
+bool VideoHandler::loadVideo(const std::string& path) {
+    return open("video:" + path);
+}
+
 cv::Mat VideoHandler::getNextFrame(double deltaTime) {
-    if (!playing || !capture.isOpened()) {
-        return currentFrame;
+    advance(deltaTime);
+    return displayFrame();
+}
+
+void VideoHandler::advance(double deltaTime) {
+    if (!playing || !source) {
+        return;
+    }
+
+    if (cache) {
+        int64_t count = cache->frameCount();
+        playhead = std::fmod(playhead + std::max(0.0, deltaTime) * videoFPS * speed, static_cast<double>(count));
+        if (playhead < 0.0) {
+            playhead += count;
+        }
+        int64_t index = std::min(static_cast<int64_t>(playhead), count - 1);
+        cache->setPlayhead(index, speed < 0.0 ? -1 : 1);
+        showCached(index);
+        return;
     }
 
     accumulator += std::max(0.0, deltaTime);
@@ -45,36 +88,82 @@ cv::Mat VideoHandler::getNextFrame(double deltaTime) {
     while (accumulator >= frameInterval) {
         accumulator -= frameInterval;
         
+        // Sources loop on their own at the end
         cv::Mat frame;
-        capture >> frame;
+        source->read(frame);
+        storeFrame(frame);
+    }
+}
 
-        if (frame.empty()) {
-            capture.set(cv::CAP_PROP_POS_FRAMES, 0);
-            capture >> frame;
-        }
+cv::Mat VideoHandler::displayFrame() {
+    if (currentFrame.empty() && !currentPlanar.empty()) {
+        cv::Mat output = framePool.acquire(cv::Size(currentPlanar.cols, currentPlanar.rows * 2 / 3), CV_8UC3);
+        convertToBgr(currentPlanar, planarLayout, output);
+        currentFrame = output;
+    }
+    return currentFrame;
+}
 
-        if (!frame.empty()) {
-            cv::rotate(frame, frame, cv::ROTATE_90_COUNTERCLOCKWISE);
-            cv::resize(frame, currentFrame, cv::Size(540, 960));
-        }
+// Each display frame lands in a pooled buffer nobody else references, so frames already handed out
+// (and kept in the history ring) are never overwritten by the next decode. Streams are converted
+// to BGR here; only cached sources keep their frames planar
+void VideoHandler::storeFrame(const cv::Mat& frame) {
+    if (frame.empty()) {
+        return;
     }
+    cv::Mat bgr;
+    convertToBgr(frame, planarLayout, bgr);
+    cv::Mat output = framePool.acquire(orienter.outputSize(), bgr.type());
+    orienter.apply(bgr, output);
+    currentFrame = output;
+    sourceFrame = bgr;
+}
 
-    return currentFrame;
+// A frame still being decoded keeps the previous one on screen; playback does not wait for it
+void VideoHandler::showCached(int64_t index) {
+    if (index == shownIndex) {
+        return;
+    }
+    CachedFrame frame;
+    if (cache->fetch(index, frame)) {
+        currentFrame = frame.display;
+        currentPlanar = frame.planar;
+        sourceFrame = frame.source;
+        shownIndex = index;
+    }
 }
 
 cv::Mat VideoHandler::getCurrentFrame() const {
+    if (currentFrame.empty() && !currentPlanar.empty()) {
+        cv::Mat bgr;
+        convertToBgr(currentPlanar, planarLayout, bgr);
+        return bgr;
+    }
     return currentFrame.clone();
 }
 
+bool VideoHandler::hasPlanarFrame() const {
+    return !currentPlanar.empty();
+}
+
+bool VideoHandler::getPlanarFrame(cv::Mat& planes, PixelLayout& layout) const {
+    if (currentPlanar.empty()) {
+        return false;
+    }
+    planes = currentPlanar;
+    layout = planarLayout;
+    return true;
+}
+
 void VideoHandler::reset() {
-    if (capture.isOpened()) {
-        capture.set(cv::CAP_PROP_POS_FRAMES, 0);
+    if (cache) {
+        seek(0);
+        return;
+    }
+    if (source && source->rewind()) {
         cv::Mat frame;
-        capture >> frame;
-        if (!frame.empty()) {
-            cv::rotate(frame, frame, cv::ROTATE_90_COUNTERCLOCKWISE);
-            cv::resize(frame, currentFrame, cv::Size(540, 960));
-        }
+        source->read(frame);
+        storeFrame(frame);
     }
 }
 
@@ -86,10 +175,81 @@ void VideoHandler::setPlaying(bool p) {
     playing = p;
 }
 
+cv::Mat VideoHandler::getDecodedFrame() const {
+    return sourceFrame;
+}
+
+cv::Mat VideoHandler::orientSource(const cv::Mat& decoded) const {
+    cv::Mat oriented;
+    if (!decoded.empty()) {
+        cv::Mat bgr;
+        convertToBgr(decoded, decoded.channels() == 1 ? planarLayout : PixelLayout::BGR, bgr);
+        orienter.orient(bgr, oriented);
+    }
+    return oriented;
+}
+
+void VideoHandler::setOrientation(Orientation orientation) {
+    orienter.configure(orientation, orienter.outputSize());
+}
+
+void VideoHandler::setOutputSize(cv::Size size) {
+    orienter.configure(orienter.orientation(), size);
+}
+
 int VideoHandler::getWidth() const {
-    return currentFrame.cols;
+    return currentFrame.empty() ? currentPlanar.cols : currentFrame.cols;
 }
 
 int VideoHandler::getHeight() const {
-    return currentFrame.rows;
+    return currentFrame.empty() ? currentPlanar.rows * 2 / 3 : currentFrame.rows;
+}
+
+double VideoHandler::getFPS() const {
+    return videoFPS;
+}
+
+std::string VideoHandler::getSourceName() const {
+    return source ? source->name() : "";
+}
+
+bool VideoHandler::isSeekable() const {
+    return cache != nullptr;
+}
+
+int64_t VideoHandler::getFrameCount() const {
+    return cache ? cache->frameCount() : -1;
+}
+
+int64_t VideoHandler::getFrameIndex() const {
+    return shownIndex;
+}
+
+// A frame that is not decoded yet appears on a later getNextFrame()
+void VideoHandler::seek(int64_t index) {
+    if (!cache) {
+        return;
+    }
+    int64_t count = cache->frameCount();
+    index = std::max<int64_t>(0, std::min(index, count - 1));
+    playhead = static_cast<double>(index);
+    cache->setPlayhead(index, speed < 0.0 ? -1 : 1);
+    showCached(index);
+}
+
+void VideoHandler::setSpeed(double value) {
+    speed = value;
+}
+
+double VideoHandler::getSpeed() const {
+    return speed;
+}
+
+// Takes effect on the next open()
+void VideoHandler::setCacheBudget(size_t bytes) {
+    cacheBudget = bytes;
+}
+
+const FrameCache* VideoHandler::getCache() const {
+    return cache.get();
 }
@@ -2,30 +2,81 @@
 #define VIDEO_HANDLER_H
 
 #include <opencv2/opencv.hpp>
+#include <memory>
 #include <string>
 
+#include "FrameCache.h"
+#include "FrameOrienter.h"
+#include "FramePool.h"
+#include "FrameSource.h"
+
 class VideoHandler {
 public:
     VideoHandler();
     ~VideoHandler();
     
+    // Any spec openFrameSource accepts; loadVideo is the plain video file case
+    bool open(const std::string& spec);
     bool loadVideo(const std::string& path);
+    // Moves playback on without producing a BGR frame; getNextFrame is advance plus displayFrame
+    void advance(double deltaTime);
     cv::Mat getNextFrame(double deltaTime);
+    // Current display frame in BGR; a planar frame is converted the first time it is asked for
+    cv::Mat displayFrame();
     cv::Mat getCurrentFrame() const;
+    // Planar sources (I420/NV12) keep their display frames planar so the GPU can do the colour
+    // conversion; planes is the display-size frame in layout, shared and read-only
+    bool hasPlanarFrame() const;
+    bool getPlanarFrame(cv::Mat& planes, PixelLayout& layout) const;
+    // Current frame as decoded (in the source's layout), before orientation and scaling; shared,
+    // must not be written
+    cv::Mat getDecodedFrame() const;
+    // A decoded frame turned to the display orientation at full resolution, in BGR; done on demand
+    // (captures) so playback never pays for a full-resolution rotation
+    cv::Mat orientSource(const cv::Mat& decoded) const;
+    // Take effect on the next open()
+    void setOrientation(Orientation orientation);
+    void setOutputSize(cv::Size size);
     void reset();
     bool isPlaying() const;
     void setPlaying(bool playing);
     int getWidth() const;
     int getHeight() const;
+    double getFPS() const;
+    std::string getSourceName() const;
+
+    // Sources of known length play through a FrameCache and support the calls below; streams
+    // (devices, synthetic) just play forward
+    bool isSeekable() const;
+    int64_t getFrameCount() const;
+    int64_t getFrameIndex() const;
+    void seek(int64_t index);
+    // Negative plays in reverse; 1 is the source rate
+    void setSpeed(double speed);
+    double getSpeed() const;
+    void setCacheBudget(size_t bytes);
+    const FrameCache* getCache() const;
     
 private:
-    cv::VideoCapture capture;
+    std::unique_ptr<FrameSource> source;
+    std::unique_ptr<FrameCache> cache;
+    size_t cacheBudget{256u << 20};
+    double playhead{0.0};
+    double speed{1.0};
+    int64_t shownIndex{-1};
     cv::Mat currentFrame;
-    std::string videoPath;
+    cv::Mat currentPlanar;
+    PixelLayout planarLayout{PixelLayout::BGR};
+    cv::Mat sourceFrame;
+    FramePool framePool;
+    FrameOrienter orienter;
     bool playing;
     double videoFPS;
     double accumulator;
     double frameInterval;
+    
+    void storeFrame(const cv::Mat& frame);
+    void showCached(int64_t index);
 };
 
 #endif
@@ -0,0 +1,227 @@
+#include "VideoRecorder.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+struct Container {
+    const char* extension;
+    int fourcc;
+};
+
+// mp4v is the most widely available writer backend; MJPG/AVI is the fallback OpenCV always ships
+const Container kContainers[] = {
+    {".mp4", cv::VideoWriter::fourcc('m', 'p', '4', 'v')},
+    {".avi", cv::VideoWriter::fourcc('M', 'J', 'P', 'G')}
+};
+}
+
+bool parseRecordPolicy(const std::string& text, RecordPolicy& policy) {
+    if (text == "duplicate") {
+        policy = RecordPolicy::DUPLICATE;
+    } else if (text == "drop") {
+        policy = RecordPolicy::DROP;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void SlotPacer::reset(double fps, double startTime) {
+    rate = fps;
+    start = startTime;
+    slotsFilled = framesDuplicated = framesDropped = 0;
+}
+
+int SlotPacer::admit(double timestamp, bool queueFull, RecordPolicy policy) {
+    int64_t due = static_cast<int64_t>(std::floor((timestamp - start) * rate)) + 1;
+    int64_t slots = due - slotsFilled;
+    if (slots <= 0) {
+        // Rendering faster than the output rate: this slot already has a frame
+        return 0;
+    }
+    if (queueFull) {
+        // Consumer is behind; leave the slots open so DUPLICATE can cover them with the next frame
+        ++framesDropped;
+        if (policy == RecordPolicy::DROP) {
+            slotsFilled = due;
+        }
+        return 0;
+    }
+
+    int repeat = policy == RecordPolicy::DUPLICATE ? static_cast<int>(slots) : 1;
+    framesDuplicated += repeat - 1;
+    slotsFilled = due;
+    return repeat;
+}
+
+bool openVideoWriter(cv::VideoWriter& writer, const std::string& basePath, double fps, cv::Size size, std::string& path) {
+    for (const auto& container : kContainers) {
+        std::string candidate = basePath + container.extension;
+        try {
+            if (writer.open(candidate, container.fourcc, fps, size, true)) {
+                path = candidate;
+                return true;
+            }
+        } catch (const cv::Exception& e) {
+            std::cerr << "Recorder error: " << e.what() << std::endl;
+        }
+    }
+    std::cerr << "Failed to open a video writer for " << basePath << std::endl;
+    return false;
+}
+
+VideoRecorder::VideoRecorder(int maxQueued) : maxQueued(std::max(1, maxQueued)) {}
+
+VideoRecorder::~VideoRecorder() {
+    stop(true);
+}
+
+void VideoRecorder::setPolicy(RecordPolicy value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    policy = value;
+}
+
+RecordPolicy VideoRecorder::getPolicy() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return policy;
+}
+
+bool VideoRecorder::start(const std::string& basePath, double sourceFps, cv::Size size, double timestamp) {
+    // A previous clip may still be flushing; its queue is bounded so this wait is short
+    join();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    double fps = sourceFps > 1.0 ? sourceFps : 30.0;
+    frameSize = size;
+    if (!openVideoWriter(writer, basePath, fps, frameSize, outputPath)) {
+        return false;
+    }
+
+    pacer.reset(fps, timestamp);
+    framesWritten = 0;
+    jobs.clear();
+    recording = true;
+    finishing = false;
+    worker = std::thread(&VideoRecorder::workerLoop, this);
+    std::cout << "Recording to " << outputPath << " at " << fps << " FPS" << std::endl;
+    return true;
+}
+
+void VideoRecorder::stop(bool wait) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (recording) {
+            recording = false;
+            finishing = true;
+        }
+    }
+    wake.notify_one();
+    if (wait) {
+        join();
+    }
+}
+
+void VideoRecorder::join() {
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+bool VideoRecorder::isRecording() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return recording;
+}
+
+bool VideoRecorder::isFinishing() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return finishing;
+}
+
+void VideoRecorder::submit(const cv::Mat& frame, double timestamp) {
+    if (frame.empty()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!recording) {
+        return;
+    }
+
+    int repeat = pacer.admit(timestamp, static_cast<int>(jobs.size()) >= maxQueued, policy);
+    if (repeat == 0) {
+        return;
+    }
+    jobs.push_back({frame, repeat});
+    wake.notify_one();
+}
+
+double VideoRecorder::elapsed(double timestamp) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return recording ? timestamp - pacer.startTime() : 0.0;
+}
+
+int64_t VideoRecorder::written() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return framesWritten;
+}
+
+int64_t VideoRecorder::duplicated() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pacer.duplicated();
+}
+
+int64_t VideoRecorder::dropped() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pacer.dropped();
+}
+
+const std::string& VideoRecorder::path() const {
+    return outputPath;
+}
+
+void VideoRecorder::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return !recording || !jobs.empty(); });
+        if (jobs.empty()) {
+            break;
+        }
+        Job job = std::move(jobs.front());
+        jobs.pop_front();
+        cv::Size size = frameSize;
+        lock.unlock();
+
+        // Published frames are shared read-only; conversions go through recycled buffers instead
+        cv::Mat output = job.frame;
+        if (output.channels() == 1) {
+            cv::Mat converted = conversionPool.acquire(output.size(), CV_8UC3);
+            cv::cvtColor(output, converted, cv::COLOR_GRAY2BGR);
+            output = converted;
+        }
+        if (output.size() != size) {
+            cv::Mat resized = conversionPool.acquire(size, CV_8UC3);
+            cv::resize(output, resized, size, 0, 0, cv::INTER_AREA);
+            output = resized;
+        }
+        try {
+            for (int i = 0; i < job.repeat; ++i) {
+                writer.write(output);
+            }
+        } catch (const cv::Exception& e) {
+            std::cerr << "Recorder error: " << e.what() << std::endl;
+        }
+        job.frame.release();
+        output.release();
+
+        lock.lock();
+        framesWritten += job.repeat;
+    }
+
+    // Flushing the container can take a while; do it without blocking submit()/isRecording()
+    lock.unlock();
+    writer.release();
+    lock.lock();
+    finishing = false;
+    std::cout << "Video saved: " << outputPath << " (" << framesWritten << " frames, "
+              << pacer.duplicated() << " duplicated, " << pacer.dropped() << " dropped)" << std::endl;
+}
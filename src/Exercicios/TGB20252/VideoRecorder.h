@@ -0,0 +1,98 @@
+#ifndef VIDEO_RECORDER_H
+#define VIDEO_RECORDER_H
+
+#include <opencv2/opencv.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "FramePool.h"
+
+// What to do with output slots that no new frame arrived for (render hitch or full queue)
+enum class RecordPolicy {
+    DUPLICATE,  // repeat the last frame so the clip keeps wall-clock duration
+    DROP        // skip the slot; every written frame is unique but the clip plays shorter
+};
+
+bool parseRecordPolicy(const std::string& text, RecordPolicy& policy);
+
+// Assigns frames to fixed-rate output slots: slot k covers [k, k + 1) / fps after start, and a frame
+// owns every open slot up to its own. Shared by every consumer that must emit a constant frame rate.
+class SlotPacer {
+public:
+    void reset(double fps, double startTime);
+    // Number of times to emit the frame; 0 when its slot is already taken or, with queueFull, when
+    // it is dropped (counted, and under DUPLICATE the open slots go to the next frame)
+    int admit(double timestamp, bool queueFull, RecordPolicy policy);
+
+    double fps() const { return rate; }
+    double startTime() const { return start; }
+    int64_t duplicated() const { return framesDuplicated; }
+    int64_t dropped() const { return framesDropped; }
+
+private:
+    double rate{30.0};
+    double start{0.0};
+    int64_t slotsFilled{0};
+    int64_t framesDuplicated{0};
+    int64_t framesDropped{0};
+};
+// Opens basePath + ".mp4", falling back to MJPG in ".avi"; path receives the file actually opened
+bool openVideoWriter(cv::VideoWriter& writer, const std::string& basePath, double fps, cv::Size size, std::string& path);
+
+// Streams processed frames into a cv::VideoWriter on its own thread. The render thread only
+// decides which output slot a frame belongs to (paced at the source FPS) and queues a shared
+// header; when the bounded queue is full the frame is dropped rather than waited on.
+class VideoRecorder {
+public:
+    explicit VideoRecorder(int maxQueued = 8);
+    ~VideoRecorder();
+
+    void setPolicy(RecordPolicy policy);
+    RecordPolicy getPolicy() const;
+
+    bool start(const std::string& basePath, double fps, cv::Size size, double timestamp);
+    // Returns immediately unless wait is set; the worker drains the queue and closes the file
+    void stop(bool wait = false);
+    bool isRecording() const;
+    bool isFinishing() const;
+
+    // frame must not be written afterwards; timestamp in seconds on the same clock as start()
+    void submit(const cv::Mat& frame, double timestamp);
+
+    double elapsed(double timestamp) const;
+    int64_t written() const;
+    int64_t duplicated() const;
+    int64_t dropped() const;
+    const std::string& path() const;
+
+private:
+    struct Job {
+        cv::Mat frame;
+        int repeat{1};
+    };
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::thread worker;
+    std::deque<Job> jobs;
+    cv::VideoWriter writer;
+    FramePool conversionPool{4};
+    RecordPolicy policy{RecordPolicy::DUPLICATE};
+    int maxQueued;
+    bool recording{false};
+    bool finishing{false};
+
+    std::string outputPath;
+    cv::Size frameSize;
+    SlotPacer pacer;
+    int64_t framesWritten{0};
+
+    void workerLoop();
+    void join();
+};
+
+#endif
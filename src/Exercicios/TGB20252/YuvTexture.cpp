@@ -0,0 +1,96 @@
+#include "YuvTexture.h"
+
+namespace {
+void setPlaneParameters() {
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+}
+}
+
+YuvTexture::YuvTexture() : textures{0, 0, 0}, width(0), height(0), current(PixelLayout::I420) {}
+
+YuvTexture::~YuvTexture() {
+    cleanup();
+}
+
+void YuvTexture::allocate(int w, int h, PixelLayout planeLayout) {
+    cleanup();
+    width = w;
+    height = h;
+    current = planeLayout;
+
+    int count = current == PixelLayout::NV12 ? 2 : 3;
+    glGenTextures(count, textures);
+    for (int i = 0; i < count; ++i) {
+        glBindTexture(GL_TEXTURE_2D, textures[i]);
+        setPlaneParameters();
+        if (i == 0) {
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+        } else if (current == PixelLayout::NV12) {
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RG8, width / 2, height / 2, 0, GL_RG, GL_UNSIGNED_BYTE, nullptr);
+        } else {
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width / 2, height / 2, 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+        }
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void YuvTexture::update(const cv::Mat& planes, PixelLayout planeLayout) {
+    if (planes.empty() || planeLayout == PixelLayout::BGR || !planes.isContinuous()) return;
+
+    int w = planes.cols;
+    int h = planes.rows * 2 / 3;
+    if (textures[0] == 0 || w != width || h != height || planeLayout != current) {
+        allocate(w, h, planeLayout);
+    }
+
+    const uchar* luma = planes.ptr();
+    const uchar* chroma = luma + static_cast<size_t>(w) * h;
+    size_t chromaPlane = static_cast<size_t>(w / 2) * (h / 2);
+
+    // Chroma rows are half the width, so they are rarely 4-byte aligned
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glBindTexture(GL_TEXTURE_2D, textures[0]);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, GL_RED, GL_UNSIGNED_BYTE, luma);
+    glBindTexture(GL_TEXTURE_2D, textures[1]);
+    if (current == PixelLayout::NV12) {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w / 2, h / 2, GL_RG, GL_UNSIGNED_BYTE, chroma);
+    } else {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w / 2, h / 2, GL_RED, GL_UNSIGNED_BYTE, chroma);
+        glBindTexture(GL_TEXTURE_2D, textures[2]);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w / 2, h / 2, GL_RED, GL_UNSIGNED_BYTE, chroma + chromaPlane);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void YuvTexture::bind() {
+    for (int i = 0; i < 3; ++i) {
+        glActiveTexture(GL_TEXTURE0 + i);
+        glBindTexture(GL_TEXTURE_2D, textures[i]);
+    }
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void YuvTexture::unbind() {
+    for (int i = 2; i >= 0; --i) {
+        glActiveTexture(GL_TEXTURE0 + i);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+}
+
+PixelLayout YuvTexture::layout() const {
+    return current;
+}
+
+void YuvTexture::cleanup() {
+    for (GLuint& texture : textures) {
+        if (texture != 0) {
+            glDeleteTextures(1, &texture);
+            texture = 0;
+        }
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef YUV_TEXTURE_H
+#define YUV_TEXTURE_H
+
+#include <glad/glad.h>
+#include <opencv2/opencv.hpp>
+
+#include "FrameSource.h"
+
+// A planar 4:2:0 frame as separate textures, for a shader to convert to RGB: Y, U and V as GL_R8
+// (I420) or Y as GL_R8 plus UV as GL_RG8 (NV12). Half the bytes of a BGR upload and no CPU
+// conversion or flip; the shader samples with the row order flipped instead.
+class YuvTexture {
+public:
+    YuvTexture();
+    ~YuvTexture();
+
+    // planes: (h * 3 / 2) x w, CV_8UC1, continuous, in layout
+    void update(const cv::Mat& planes, PixelLayout layout);
+    // Y on texture unit 0, U (or UV) on 1, V on 2; leaves unit 0 active
+    void bind();
+    void unbind();
+    PixelLayout layout() const;
+    void cleanup();
+
+private:
+    GLuint textures[3];
+    int width;
+    int height;
+    PixelLayout current;
+
+    void allocate(int w, int h, PixelLayout planeLayout);
+};
+
+#endif
@@ -13,44 +13,141 @@
 #include <imgui_impl_opengl3.h>
 #include <iostream>
 #include <ctime>
+#include <cstdlib>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
 
 #include "TextureManager.h"
+#include "YuvTexture.h"
 #include "VideoHandler.h"
 #include "FilterManager.h"
 #include "StickerManager.h"
 #include "FaceDetector.h"
 #include "OverlayManager.h"
+#include "TiledExecutor.h"
+#include "PixelKernels.h"
+#include "Autotuner.h"
+#include "TemporalReuse.h"
+#include "FrameHistory.h"
+#include "ScopeAnalyzer.h"
+#include "ProgressiveRenderer.h"
+#include "CaptureEncoder.h"
+#include "CaptureRenderer.h"
+#include "VideoRecorder.h"
+#include "FrameSink.h"
+#include "RetroCapture.h"
+#include "PhotoGallery.h"
+#include "FilterPreviewStrip.h"
+#include "FrameGovernor.h"
+#include "Benchmark.h"
+#include "OptionParsing.h"
 
 constexpr int WINDOW_WIDTH = 540;
 constexpr int WINDOW_HEIGHT = 960;
 
 class VIApp {
 public:
+    enum class AutotuneMode { OFF, AUTO, FORCE };
+
     VIApp();
     ~VIApp();
 
     bool initialize();
     void run();
     void cleanup();
+    void setPrecision(IntermediatePrecision precision);
+    void setTiledExecution(bool enabled);
+    void setAutotuneMode(AutotuneMode mode);
+    void setIsaPinned(bool pinned);
+    void setTemporalReuse(bool enabled, double threshold);
+    void setScopes(bool enabled, double budgetMs);
+    void setProgressiveEditing(bool enabled);
+    void setFrameGovernor(bool enabled, double budgetMs);
+    void setEncodeOptions(const EncodeOptions& options);
+    void setRecordPolicy(RecordPolicy policy);
+    bool setSink(const SinkOptions& options, RecordPolicy policy);
+    void setRetroCapture(double seconds, RetroFormat format);
+    void setAnimationOptions(const AnimationOptions& options);
+    void setSource(const std::string& spec);
+    void setFrameCache(size_t megabytes);
+    void setOrientation(Orientation orientation);
 
 private:
     enum class AppMode { PHOTO, VIDEO };
 
     GLFWwindow* window{};
     TextureManager textureManager;
+    YuvTexture planarTexture;
     VideoHandler videoHandler;
+    std::string sourceSpec{"../assets/videos/camera_video.mp4"};
     FilterManager filterManager;
     StickerManager stickerManager;
     FaceDetector faceDetector;
     OverlayManager overlayManager;
+    TiledExecutor tiledExecutor;
+    Autotuner autotuner;
+    TemporalReuse temporalReuse;
+    FrameHistory frameHistory{std::max(8, maxHistoryFrames())};
+    ProgressiveRenderer progressiveRenderer;
+    CaptureEncoder captureEncoder;
+    CaptureRenderer captureRenderer;
+    FrameGovernor governor;
+    ScopeAnalyzer scopeAnalyzer;
+    ScopeData scopeData;
+    TextureManager waveformTexture;
+    TextureManager paradeTexture;
 
     cv::Mat liveFrame;
+    cv::Mat liveSource;
+    uint64_t liveFrameId{0};
     cv::Mat frameBuffer;
+    // Unedited playback of a planar source skips the BGR frame: the planes go straight to the GPU
+    bool planarDisplay{false};
+    cv::Mat livePlanar;
+    PixelLayout livePlanarLayout{PixelLayout::I420};
+    uint64_t livePlanarId{0};
+    uint64_t uploadedPlanarId{0};
 
     FilterType currentFilter{FilterType::NONE};
     OverlayType currentOverlay{OverlayType::NONE};
     AppMode appMode{AppMode::VIDEO};
     bool faceDetectionEnabled{false};
+    bool tiledExecution{true};
+    AutotuneMode autotuneMode{AutotuneMode::AUTO};
+    bool isaPinned{false};
+    bool temporalReuseEnabled{false};
+    bool scopesEnabled{false};
+    bool progressiveEditing{true};
+    bool captureRequested{false};
+    bool governorPanel{false};
+    double budgetOverride{0.0};
+    std::vector<FaceData> lastFaces;
+    cv::Mat lastFaceMask;
+    cv::Size lastFaceSize;
+    int faceFrameCounter{0};
+    uint64_t lastPipelineKey{0};
+    bool pipelineValid{false};
+    bool lastRunRefining{false};
+    bool frameDirty{true};
+    int idleFrames{0};
+    bool burstActive{false};
+    std::string burstName;
+    int burstCount{0};
+    uint64_t lastBurstFrameId{0};
+    VideoRecorder videoRecorder;
+    FrameSink frameSink;
+    RetroCapture retroCapture;
+    double retroSeconds{5.0};
+    RetroFormat retroFormat{RetroFormat::CLIP};
+    uint64_t lastRetroFrameId{0};
+    PhotoGallery gallery{".."};
+    bool galleryOpen{false};
+    FilterPreviewStrip filterPreviews{filterManager};
+    bool filterPreviewsEnabled{false};
+    int defaultThreads{0};
+    CpuIsa defaultIsa{CpuIsa::SCALAR};
     bool webcamEnabled{true};
     bool enableR{true};
     bool enableG{true};
@@ -59,6 +156,7 @@ private:
     int draggedSticker{-1};
 
     GLuint shaderProgram{};
+    GLuint planarProgram{};
     GLuint VAO{};
     GLuint VBO{};
     GLuint EBO{};
@@ -69,6 +167,7 @@ private:
 
     void initOpenGL();
     void initShaders();
+    static GLuint linkProgram(const char* vertexSource, const char* fragmentSource);
     void initGeometry();
     void initImGui();
     void renderImGui();
@@ -76,20 +175,48 @@ private:
     void processFrame();
     void renderFrame();
     void switchMode();
-    void saveCurrentImage() const;
+    void saveCurrentImage();
+    void setBurst(bool active);
+    void captureBurstFrame();
+    void setRecording(bool active);
+    void recordFrame();
+    void captureRetroFrame();
+    void saveRetroWindow();
     void resetImage();
     void updateVideoFeed();
+    bool canDisplayPlanar() const;
     void applyOfflineOverlay();
+    void drawOfflineLabel();
+    void ensureColorFrame();
     void drawFiltersPanel();
     void drawOverlayPanel();
     void drawTopButtons();
     void drawPhotoHud();
     void drawVideoHud();
+    void drawTimeline();
     void drawWebcamButton();
+    void drawScopesPanel();
+    void drawGovernorPanel();
+    void drawCaptureStatus();
+    void drawGalleryPanel();
+    void drawFilterPreviews();
+    void updateFilterPreviews();
+    void setGallery(bool open);
     bool centeredButton(const char* label, const ImVec2& size);
     void handleFaceProcessing();
     void applyFiltersAndOverlays();
     void applyStickersLayer();
+    void runTiledChain();
+    void runProgressiveEdit(bool planTiled);
+    FilterParams pipelineParams() const;
+    void prepareExecutionPlans();
+    bool applyExecutionPlan();
+    bool usesTemporalReuse() const;
+    void runPipeline();
+    void shareHistory();
+    void recordHistory();
+    uint64_t pipelineKey() const;
+    bool isIdle() const;
 
     static void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
     static void cursorPosCallback(GLFWwindow* window, double xpos, double ypos);
@@ -98,7 +225,12 @@ private:
 
 VIApp* VIApp::instance = nullptr;
 
-VIApp::VIApp() {
+VIApp::VIApp()
+    : tiledExecutor(filterManager, overlayManager, stickerManager),
+      autotuner(filterManager, tiledExecutor, "../viapp_autotune.yml"),
+      temporalReuse(filterManager),
+      progressiveRenderer(filterManager, overlayManager, tiledExecutor),
+      captureRenderer(filterManager, stickerManager, captureEncoder) {
     instance = this;
 }
 
@@ -137,33 +269,138 @@ bool VIApp::initialize() {
 
     glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
 
+    const GLFWvidmode* videoMode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+    if (budgetOverride > 0.0) {
+        governor.setBudget(budgetOverride);
+    } else if (videoMode && videoMode->refreshRate > 0) {
+        governor.setBudget(1000.0 / videoMode->refreshRate);
+    }
+
     initOpenGL();
     initShaders();
     initGeometry();
     initImGui();
 
     textureManager.createTexture(WINDOW_WIDTH, WINDOW_HEIGHT);
+    waveformTexture.createTexture(1, 256);
+    paradeTexture.createTexture(3, 256);
 
-    if (!videoHandler.loadVideo("../assets/videos/camera_video.mp4")) {
-        std::cerr << "Warning: Could not load video file" << std::endl;
+    videoHandler.setOutputSize(cv::Size(WINDOW_WIDTH, WINDOW_HEIGHT));
+    if (!videoHandler.open(sourceSpec)) {
+        std::cerr << "Warning: Could not open frame source " << sourceSpec << std::endl;
         liveFrame = cv::Mat(WINDOW_HEIGHT, WINDOW_WIDTH, CV_8UC3, cv::Scalar(60, 60, 60));
         cv::putText(liveFrame, "No Camera Feed", cv::Point(100, WINDOW_HEIGHT / 2), cv::FONT_HERSHEY_SIMPLEX, 1.0,
                     cv::Scalar(180, 180, 180), 2);
         videoHandler.setPlaying(false);
     } else {
+        std::cout << "Frame source: " << videoHandler.getSourceName() << " at " << videoHandler.getFPS() << " fps" << std::endl;
         videoHandler.setPlaying(true);
         liveFrame = videoHandler.getCurrentFrame();
+        liveSource = videoHandler.getDecodedFrame();
     }
 
     frameBuffer = liveFrame.clone();
+    ++liveFrameId;
+    retroCapture.configure(retroSeconds, videoHandler.getFPS());
+    if (frameSink.isConfigured()) {
+        frameSink.start(videoHandler.getFPS(), frameBuffer.size(), glfwGetTime());
+    }
 
     stickerManager.loadStickers();
     overlayManager.load(WINDOW_WIDTH, WINDOW_HEIGHT);
     faceDetector.initialize();
 
+    prepareExecutionPlans();
+
     return true;
 }
 
+void VIApp::setPrecision(IntermediatePrecision precision) {
+    filterManager.setPrecision(precision);
+    overlayManager.setPrecision(precision);
+}
+
+void VIApp::setTiledExecution(bool enabled) {
+    tiledExecution = enabled;
+}
+
+void VIApp::setAutotuneMode(AutotuneMode mode) {
+    autotuneMode = mode;
+}
+
+void VIApp::setIsaPinned(bool pinned) {
+    isaPinned = pinned;
+}
+
+void VIApp::setTemporalReuse(bool enabled, double threshold) {
+    temporalReuseEnabled = enabled;
+    temporalReuse.setThreshold(threshold);
+    temporalReuse.reset();
+}
+
+void VIApp::setProgressiveEditing(bool enabled) {
+    progressiveEditing = enabled;
+    if (!enabled) {
+        progressiveRenderer.stop();
+    }
+}
+
+// budgetMs <= 0 keeps the default of one refresh interval of the primary monitor
+void VIApp::setFrameGovernor(bool enabled, double budgetMs) {
+    governor.setEnabled(enabled);
+    budgetOverride = budgetMs;
+    if (budgetMs > 0.0) {
+        governor.setBudget(budgetMs);
+    }
+}
+
+void VIApp::setScopes(bool enabled, double budgetMs) {
+    scopesEnabled = enabled;
+    scopeAnalyzer.setBudget(budgetMs);
+    if (enabled) {
+        // Rerun once so a memoized frame gets analysed
+        pipelineValid = false;
+        scopeAnalyzer.start();
+    } else {
+        scopeAnalyzer.stop();
+    }
+}
+
+// Block reuse only pays off on a live feed; stills and the frozen offline frame are filtered once anyway
+bool VIApp::usesTemporalReuse() const {
+    return temporalReuseEnabled && appMode == AppMode::VIDEO && webcamEnabled && TemporalReuse::canReuse(currentFilter);
+}
+
+void VIApp::prepareExecutionPlans() {
+    defaultThreads = cv::getNumThreads();
+    defaultIsa = activeCpuIsa();
+    if (autotuneMode == AutotuneMode::OFF) {
+        return;
+    }
+
+    int cached = autotuneMode == AutotuneMode::FORCE ? 0 : autotuner.load();
+    if (cached > 0) {
+        std::cout << "Loaded " << cached << " autotuned execution plans" << std::endl;
+    }
+    if (autotuneMode == AutotuneMode::FORCE || !autotuner.isTuned(liveFrame.size())) {
+        autotuner.start(liveFrame);
+    }
+}
+
+// Switches threads and kernel ISA to the tuned winner for the current filter; returns whether it tiles
+bool VIApp::applyExecutionPlan() {
+    ExecutionPlan plan = filterManager.executionPlan(currentFilter, liveFrame.size());
+    int threads = plan.tuned ? plan.threads : defaultThreads;
+    CpuIsa isa = plan.tuned && !isaPinned ? plan.isa : defaultIsa;
+    if (cv::getNumThreads() != threads) {
+        cv::setNumThreads(threads);
+    }
+    if (activeCpuIsa() != isa) {
+        forceCpuIsa(isa);
+    }
+    return plan.tiled;
+}
+
 void VIApp::initOpenGL() {
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glEnable(GL_BLEND);
@@ -191,22 +428,55 @@ void VIApp::initShaders() {
             FragColor = texture(texture1, TexCoord);
         }
     )";
-    
+
+    // BT.601 limited range, the same conversion as cv::COLOR_YUV2BGR_I420. The planes are uploaded
+    // top row first (no CPU flip), so rows are sampled in reverse
+    const char* planarFragmentSource = R"(
+        #version 400 core
+        out vec4 FragColor;
+        in vec2 TexCoord;
+        uniform sampler2D yPlane;
+        uniform sampler2D uPlane;
+        uniform sampler2D vPlane;
+        uniform bool interleaved;
+        void main() {
+            vec2 coord = vec2(TexCoord.x, 1.0 - TexCoord.y);
+            float luma = 1.164 * (texture(yPlane, coord).r - 0.0627);
+            vec2 chroma = interleaved ? texture(uPlane, coord).rg
+                                      : vec2(texture(uPlane, coord).r, texture(vPlane, coord).r);
+            chroma -= vec2(0.502);
+            FragColor = vec4(luma + 1.596 * chroma.y,
+                             luma - 0.391 * chroma.x - 0.813 * chroma.y,
+                             luma + 2.018 * chroma.x, 1.0);
+        }
+    )";
+
+    shaderProgram = linkProgram(vertexShaderSource, fragmentShaderSource);
+    planarProgram = linkProgram(vertexShaderSource, planarFragmentSource);
+    glUseProgram(planarProgram);
+    glUniform1i(glGetUniformLocation(planarProgram, "yPlane"), 0);
+    glUniform1i(glGetUniformLocation(planarProgram, "uPlane"), 1);
+    glUniform1i(glGetUniformLocation(planarProgram, "vPlane"), 2);
+    glUseProgram(0);
+}
+
+GLuint VIApp::linkProgram(const char* vertexSource, const char* fragmentSource) {
     GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, nullptr);
+    glShaderSource(vertexShader, 1, &vertexSource, nullptr);
     glCompileShader(vertexShader);
     
     GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, nullptr);
+    glShaderSource(fragmentShader, 1, &fragmentSource, nullptr);
     glCompileShader(fragmentShader);
     
-    shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
     
     glDeleteShader(vertexShader);
     glDeleteShader(fragmentShader);
+    return program;
 }
 
 void VIApp::initGeometry() {
@@ -277,6 +547,7 @@ void VIApp::initImGui() {
 void VIApp::switchMode() {
     appMode = (appMode == AppMode::VIDEO) ? AppMode::PHOTO : AppMode::VIDEO;
     if (appMode == AppMode::VIDEO) {
+        progressiveRenderer.cancel();
         stickerManager.clearStickers();
         selectedSticker = -1;
         if (webcamEnabled) {
@@ -288,16 +559,141 @@ void VIApp::switchMode() {
     }
 }
 
-void VIApp::saveCurrentImage() const {
+// With a source frame the edit is replayed at full resolution in the background; without one
+// (webcam offline, frozen frame) the preview on screen is what gets saved
+void VIApp::saveCurrentImage() {
     if (frameBuffer.empty()) {
         return;
     }
     std::time_t now = std::time(nullptr);
-    std::string filename = "../viapp_photo_" + std::to_string(now) + ".png";
-    if (cv::imwrite(filename, frameBuffer)) {
-        std::cout << "Photo saved: " << filename << std::endl;
+    std::string filename = "../viapp_photo_" + std::to_string(now);
+
+    EditRecipe recipe;
+    if (liveSource.empty() || !webcamEnabled) {
+        captureRenderer.submit(frameBuffer, recipe, filename);
+        return;
+    }
+    recipe.filter = currentFilter;
+    recipe.params = filterManager.snapshot();
+    recipe.overlay = currentOverlay;
+    recipe.stickers = stickerManager.placements();
+    recipe.previewSize = liveFrame.size();
+    // Playback never rotates at full resolution; only a capture does
+    cv::Mat source = videoHandler.orientSource(liveSource);
+    captureRenderer.submit(source, recipe, filename);
+    std::cout << "Rendering " << source.cols << "x" << source.rows << " capture..." << std::endl;
+}
+
+void VIApp::setEncodeOptions(const EncodeOptions& options) {
+    captureEncoder.setOptions(options);
+}
+
+void VIApp::setSource(const std::string& spec) {
+    sourceSpec = spec;
+}
+
+void VIApp::setFrameCache(size_t megabytes) {
+    videoHandler.setCacheBudget(megabytes << 20);
+}
+
+void VIApp::setOrientation(Orientation orientation) {
+    videoHandler.setOrientation(orientation);
+}
+
+void VIApp::setRecordPolicy(RecordPolicy policy) {
+    videoRecorder.setPolicy(policy);
+}
+
+// Clips run at the source rate, not the display rate; stopping returns at once and the file is
+// finished in the background
+void VIApp::setRecording(bool active) {
+    if (active == videoRecorder.isRecording()) {
+        return;
+    }
+    if (!active) {
+        videoRecorder.stop();
+        return;
+    }
+    if (frameBuffer.empty()) {
+        return;
+    }
+    std::string filename = "../viapp_record_" + std::to_string(std::time(nullptr));
+    videoRecorder.start(filename, videoHandler.getFPS(), frameBuffer.size(), glfwGetTime());
+}
+
+// Offered every loop; the recorder and the sink keep one frame per output slot and never block
+void VIApp::recordFrame() {
+    double now = glfwGetTime();
+    videoRecorder.submit(frameBuffer, now);
+    frameSink.submit(frameBuffer, now);
+}
+
+// Claimed before anything is printed, so a stdout stream never has log lines mixed in
+bool VIApp::setSink(const SinkOptions& options, RecordPolicy policy) {
+    frameSink.setPolicy(policy);
+    return frameSink.configure(options);
+}
+
+// seconds <= 0 turns the buffer off; the ring is sized in initialize() once the source FPS is known
+void VIApp::setRetroCapture(double seconds, RetroFormat format) {
+    retroSeconds = std::max(0.0, seconds);
+    retroFormat = format;
+}
+
+void VIApp::setAnimationOptions(const AnimationOptions& options) {
+    retroCapture.setAnimationOptions(options);
+}
+
+// Every new processed frame goes into the ring, so saving always covers the last retroSeconds.
+// On the planar display path the frame on screen is the unedited planes, which go in as they are
+void VIApp::captureRetroFrame() {
+    if (retroSeconds <= 0.0) {
+        return;
+    }
+    // Tagged like the progressive source id so the two frame counters never collide
+    uint64_t key = planarDisplay ? (livePlanarId << 1) | 1u : liveFrameId << 1;
+    const cv::Mat& frame = planarDisplay ? livePlanar : frameBuffer;
+    if (frame.empty() || key == lastRetroFrameId) {
+        return;
+    }
+    lastRetroFrameId = key;
+    retroCapture.push(frame, glfwGetTime(), planarDisplay ? livePlanarLayout : PixelLayout::BGR);
+}
+
+void VIApp::saveRetroWindow() {
+    if (retroSeconds <= 0.0) {
+        return;
+    }
+    std::string filename = "../viapp_retro_" + std::to_string(std::time(nullptr));
+    if (retroCapture.save(filename, retroFormat)) {
+        std::cout << "Saving last " << retroCapture.span() << " s (" << retroCapture.size() << " frames)..." << std::endl;
+    }
+}
+
+void VIApp::setBurst(bool active) {
+    if (active == burstActive) {
+        return;
+    }
+    burstActive = active;
+    if (active) {
+        burstName = "../viapp_burst_" + std::to_string(std::time(nullptr)) + "_";
+        burstCount = 0;
+        lastBurstFrameId = 0;
     } else {
-        std::cerr << "Failed to save photo" << std::endl;
+        std::cout << "Burst: " << burstCount << " frames queued, " << captureEncoder.dropped() << " dropped in total" << std::endl;
+    }
+}
+
+// One file per new processed frame while B is held; frames are queued by reference, never copied
+void VIApp::captureBurstFrame() {
+    if (!burstActive || frameBuffer.empty() || liveFrameId == lastBurstFrameId) {
+        return;
+    }
+    lastBurstFrameId = liveFrameId;
+    char index[8];
+    snprintf(index, sizeof(index), "%04d", burstCount);
+    if (captureEncoder.submit(frameBuffer, burstName + index)) {
+        ++burstCount;
     }
 }
 
@@ -312,12 +708,45 @@ void VIApp::resetImage() {
 }
 
 void VIApp::updateVideoFeed() {
-    if (!webcamEnabled || !videoHandler.isPlaying()) {
+    bool wasPlanar = planarDisplay;
+    planarDisplay = canDisplayPlanar();
+    if (planarDisplay) {
+        videoHandler.advance(frameDelta);
+        cv::Mat planes;
+        PixelLayout layout;
+        if (videoHandler.getPlanarFrame(planes, layout) && planes.data != livePlanar.data) {
+            livePlanar = planes;
+            livePlanarLayout = layout;
+            ++livePlanarId;
+        }
+        return;
+    }
+    livePlanar.release();
+
+    // Leaving the planar path converts the frame on screen even when playback is paused
+    if (!webcamEnabled || (!videoHandler.isPlaying() && !wasPlanar)) {
         return;
     }
     cv::Mat frame = videoHandler.getNextFrame(frameDelta);
-    if (!frame.empty()) {
+    if (!frame.empty() && frame.data != liveFrame.data) {
         liveFrame = frame;
+        liveSource = videoHandler.getDecodedFrame();
+        ++liveFrameId;
+    }
+}
+
+// Only while nothing reads the BGR frame: no edit, no capture of any kind, no scopes or previews.
+// The retro ring is the exception, since it takes the planes and converts them on its own thread
+bool VIApp::canDisplayPlanar() const {
+    return webcamEnabled && appMode == AppMode::VIDEO && videoHandler.hasPlanarFrame() &&
+           currentFilter == FilterType::NONE && currentOverlay == OverlayType::NONE && !faceDetectionEnabled &&
+           !captureRequested && !burstActive && !videoRecorder.isRecording() && !frameSink.isActive() &&
+           !scopesEnabled && !filterPreviewsEnabled;
+}
+
+void VIApp::ensureColorFrame() {
+    if (!frameBuffer.empty() && frameBuffer.channels() == 1) {
+        cv::cvtColor(frameBuffer, frameBuffer, cv::COLOR_GRAY2BGR);
     }
 }
 
@@ -325,10 +754,16 @@ void VIApp::applyOfflineOverlay() {
     if (frameBuffer.empty()) {
         return;
     }
+    ensureColorFrame();
 
-    cv::Mat overlay(frameBuffer.size(), frameBuffer.type(), cv::Scalar(0, 0, 0));
-    cv::addWeighted(overlay, 0.85, frameBuffer, 0.15, 0.0, frameBuffer);
+    // Out of place: frameBuffer may still share pixels with liveFrame
+    cv::Mat dimmed;
+    frameBuffer.convertTo(dimmed, -1, 0.15);
+    frameBuffer = dimmed;
+    drawOfflineLabel();
+}
 
+void VIApp::drawOfflineLabel() {
     const std::string text = "WEBCAM OFFLINE";
     int baseline = 0;
     cv::Size size = cv::getTextSize(text, cv::FONT_HERSHEY_SIMPLEX, 1.0, 2, &baseline);
@@ -342,36 +777,61 @@ void VIApp::handleFaceProcessing() {
         return;
     }
 
-    std::vector<FaceData> faces = faceDetector.detectFaces(frameBuffer);
+    StageTimer timer(governor, GovernorStage::FACE);
+    // Under load the cascade only runs every few frames; faces move little in between
+    bool reuse = governor.active(Degradation::FACE_SKIP) && lastFaceSize == frameBuffer.size() &&
+                 (faceFrameCounter++ % 4) != 0;
+    if (!reuse) {
+        lastFaces = faceDetector.detectFaces(frameBuffer);
+        lastFaceMask = lastFaces.empty() ? cv::Mat() : faceDetector.createFaceMask(frameBuffer, lastFaces);
+        lastFaceSize = frameBuffer.size();
+    }
+    const std::vector<FaceData>& faces = lastFaces;
     if (faces.empty()) {
         filterManager.setFaceMask(cv::Mat());
         return;
     }
 
-    cv::Mat mask = faceDetector.createFaceMask(frameBuffer, faces);
-    filterManager.setFaceMask(mask);
+    filterManager.setFaceMask(lastFaceMask);
     if (faceDetectionEnabled) {
+        if (frameBuffer.data == liveFrame.data) {
+            frameBuffer = liveFrame.clone();
+        }
         faceDetector.drawFaces(frameBuffer, faces);
     }
 }
 
 void VIApp::applyFiltersAndOverlays() {
-    if (currentFilter == FilterType::RGB_CHANNELS) {
+    if (filterInfo(currentFilter).params & PARAM_RGB_TOGGLES) {
         filterManager.setRGBChannels(enableR, enableG, enableB);
     }
 
-    if (currentFilter != FilterType::NONE) {
-        frameBuffer = filterManager.applyFilter(frameBuffer, currentFilter, ChannelMode::RGB);
+    if (usesTemporalReuse()) {
+        frameBuffer = temporalReuse.apply(frameBuffer, currentFilter, pipelineParams());
+    } else if (currentFilter != FilterType::NONE) {
+        FilterParams params = pipelineParams();
+        if (governor.active(Degradation::HALF_RESOLUTION)) {
+            frameBuffer = filterManager.applyFilterAtScale(frameBuffer, currentFilter, params, 0.5);
+        } else {
+            frameBuffer = filterManager.applyFilter(frameBuffer, currentFilter, params, ChannelMode::RGB);
+        }
     }
 
     if (currentOverlay != OverlayType::NONE) {
+        ensureColorFrame();
         frameBuffer = overlayManager.apply(frameBuffer, currentOverlay);
     }
 }
 
 void VIApp::applyStickersLayer() {
+    bool preview = selectedSticker >= 0 && !governor.active(Degradation::STICKER_PREVIEW);
+    if (stickerManager.getStickerCount() == 0 && !preview) {
+        return;
+    }
+    StageTimer timer(governor, GovernorStage::STICKERS);
+    ensureColorFrame();
     frameBuffer = stickerManager.applyStickers(frameBuffer);
-    if (selectedSticker >= 0) {
+    if (preview) {
         double xpos = 0.0;
         double ypos = 0.0;
         glfwGetCursorPos(window, &xpos, &ypos);
@@ -379,18 +839,193 @@ void VIApp::applyStickersLayer() {
     }
 }
 
+void VIApp::runTiledChain() {
+    if (filterInfo(currentFilter).params & PARAM_RGB_TOGGLES) {
+        filterManager.setRGBChannels(enableR, enableG, enableB);
+    }
 
+    ChainSpec spec;
+    spec.filter = currentFilter;
+    spec.params = pipelineParams();
+    spec.overlay = currentOverlay;
+    spec.dimmed = !webcamEnabled;
+    if (appMode == AppMode::PHOTO) {
+        spec.stickers = stickerManager.getStickerCount() > 0;
+        if (selectedSticker >= 0 && !governor.active(Degradation::STICKER_PREVIEW)) {
+            double xpos = 0.0;
+            double ypos = 0.0;
+            glfwGetCursorPos(window, &xpos, &ypos);
+            spec.previewSticker = selectedSticker;
+            spec.previewPosition = cv::Point(xpos, ypos);
+        }
+    }
+
+    frameBuffer = tiledExecutor.run(frameBuffer, spec);
+}
+
+// Live parameters, cheapened while the governor is shedding load (captures use the real snapshot)
+FilterParams VIApp::pipelineParams() const {
+    FilterParams params = filterManager.snapshot();
+    if (governor.active(Degradation::CHEAP_FILTER)) {
+        params.kernelSize = std::min(params.kernelSize, 7);
+        params.precision = IntermediatePrecision::FIXED16;
+    }
+    return params;
+}
+
+
+
+// Filter and overlay go through the progressive renderer; stickers stay on this thread because
+// they are edited by the mouse callbacks and are cheap enough to redraw every frame
+void VIApp::runProgressiveEdit(bool planTiled) {
+    if (filterInfo(currentFilter).params & PARAM_RGB_TOGGLES) {
+        filterManager.setRGBChannels(enableR, enableG, enableB);
+    }
+
+    ChainSpec spec;
+    spec.filter = currentFilter;
+    spec.params = pipelineParams();
+    spec.overlay = currentOverlay;
+    bool tiled = tiledExecution && planTiled && TiledExecutor::canTile(currentFilter);
+    // Face boxes are drawn into the input, so they count as a different source
+    uint64_t sourceId = (liveFrameId << 1) | (faceDetectionEnabled ? 1u : 0u);
+    // Captures are replayed from the source frame, so only a preview-only capture needs the refined frame
+    bool full = captureRequested && (liveSource.empty() || !webcamEnabled);
+    frameBuffer = progressiveRenderer.render(frameBuffer, sourceId, spec, tiled, full);
+}
 
 void VIApp::processFrame() {
     updateVideoFeed();
+    if (planarDisplay) {
+        // Nothing to process; the BGR texture is out of date once the planes have been shown
+        pipelineValid = false;
+        return;
+    }
     if (liveFrame.empty()) {
         return;
     }
 
-    frameBuffer = liveFrame.clone();
+    // The tuner owns the thread count and ISA and times filters while it runs; filtering here would
+    // run on its settings and skew its timings, so the raw feed is shown until it is done
+    if (autotuner.isRunning()) {
+        frameDirty = frameBuffer.data != liveFrame.data;
+        frameBuffer = liveFrame;
+        pipelineValid = false;
+        return;
+    }
+
+    // Same frame and same edit: the last output is still valid, skip face detection and every stage.
+    // A refinement that landed since the last run is picked up even though nothing else changed.
+    uint64_t key = pipelineKey();
+    bool refinementLanded = lastRunRefining && !progressiveRenderer.isRefining();
+    frameDirty = !pipelineValid || key != lastPipelineKey || captureRequested || refinementLanded;
+    if (!frameDirty) {
+        return;
+    }
+    lastPipelineKey = key;
+    pipelineValid = true;
+
+    // No copy up front: every stage below writes into a new buffer before touching pixels
+    frameBuffer = liveFrame;
+
+    shareHistory();
+    runPipeline();
+    recordHistory();
+    lastRunRefining = progressiveRenderer.isRefining();
+
+    // Deferred to here so a preview capture is the refined frame, never the low-resolution one
+    if (captureRequested) {
+        captureRequested = false;
+        saveCurrentImage();
+    }
+
+    if (scopesEnabled) {
+        scopeAnalyzer.submit(frameBuffer);
+    }
+}
+
+// Everything the pipeline output depends on: source frame, edit, stickers and load-shedding level
+uint64_t VIApp::pipelineKey() const {
+    uint64_t key = hashCombine(liveFrameId, FilterManager::hashParams(filterManager.snapshot()));
+    key = hashCombine(key, static_cast<uint64_t>(stickerManager.revision()));
+    key = hashCombine(key, static_cast<uint64_t>(currentFilter));
+    key = hashCombine(key, static_cast<uint64_t>(currentOverlay));
+    key = hashCombine(key, (appMode == AppMode::PHOTO ? 1u : 0u) | (webcamEnabled ? 2u : 0u) |
+                               (faceDetectionEnabled ? 4u : 0u) | (temporalReuseEnabled ? 8u : 0u));
+    key = hashCombine(key, static_cast<uint64_t>(governor.level()));
+    if (appMode == AppMode::PHOTO && selectedSticker >= 0) {
+        double xpos = 0.0;
+        double ypos = 0.0;
+        glfwGetCursorPos(window, &xpos, &ypos);
+        key = hashCombine(key, static_cast<uint64_t>(selectedSticker));
+        key = hashCombine(key, (static_cast<uint64_t>(xpos) << 32) | static_cast<uint64_t>(ypos));
+    }
+    return key;
+}
+
+// Nothing will change until the user does something: no playing source, no pending background work
+bool VIApp::isIdle() const {
+    bool playing = webcamEnabled && videoHandler.isPlaying();
+    return !playing && pipelineValid && !autotuner.isRunning() && !lastRunRefining && !captureRequested && captureRenderer.pending() == 0 &&
+           captureEncoder.pending() == 0 && !videoRecorder.isRecording() && !videoRecorder.isFinishing() &&
+           !frameSink.isActive() &&
+           !retroCapture.isSaving() && !(galleryOpen && gallery.busy()) &&
+           !(filterPreviewsEnabled && filterPreviews.busy()) && pipelineKey() == lastPipelineKey;
+}
+
+// Previous raw frames for temporal filters, excluding the one being processed (the render loop
+// runs faster than the video, so the same frame is processed several times)
+void VIApp::shareHistory() {
+    std::vector<cv::Mat> frames;
+    int wanted = maxHistoryFrames();
+    for (int age = 0; age < frameHistory.size() && static_cast<int>(frames.size()) < wanted; ++age) {
+        const cv::Mat& raw = frameHistory.at(age).raw;
+        if (raw.data != liveFrame.data) {
+            frames.push_back(raw);
+        }
+    }
+    filterManager.setHistory(std::move(frames));
+}
+
+void VIApp::recordHistory() {
+    if (!webcamEnabled || appMode != AppMode::VIDEO) {
+        return;
+    }
+    if (!frameHistory.empty() && frameHistory.at(0).raw.data == liveFrame.data) {
+        return;
+    }
+    frameHistory.push(liveFrame, frameBuffer, glfwGetTime());
+}
 
+void VIApp::runPipeline() {
     handleFaceProcessing();
-    applyFiltersAndOverlays();
+
+    bool planTiled = applyExecutionPlan();
+    if (appMode == AppMode::PHOTO && progressiveEditing) {
+        {
+            StageTimer timer(governor, GovernorStage::FILTER);
+            runProgressiveEdit(planTiled);
+        }
+        applyStickersLayer();
+        if (!webcamEnabled) {
+            applyOfflineOverlay();
+        }
+        return;
+    }
+    bool halfResolution = governor.active(Degradation::HALF_RESOLUTION) && currentFilter != FilterType::NONE;
+    if (tiledExecution && planTiled && TiledExecutor::canTile(currentFilter) && !usesTemporalReuse() && !halfResolution) {
+        StageTimer timer(governor, GovernorStage::FILTER);
+        runTiledChain();
+        if (!webcamEnabled) {
+            drawOfflineLabel();
+        }
+        return;
+    }
+
+    {
+        StageTimer timer(governor, GovernorStage::FILTER);
+        applyFiltersAndOverlays();
+    }
 
     if (appMode == AppMode::PHOTO) {
         applyStickersLayer();
@@ -402,20 +1037,37 @@ void VIApp::processFrame() {
 }
 
 void VIApp::renderFrame() {
-    if (frameBuffer.empty()) {
+    if (frameBuffer.empty() && !planarDisplay) {
         return;
     }
 
     glClear(GL_COLOR_BUFFER_BIT);
 
-    textureManager.updateTexture(frameBuffer);
-
-    glUseProgram(shaderProgram);
-    textureManager.bind();
+    if (planarDisplay) {
+        if (uploadedPlanarId != livePlanarId) {
+            StageTimer timer(governor, GovernorStage::UPLOAD);
+            planarTexture.update(livePlanar, livePlanarLayout);
+            uploadedPlanarId = livePlanarId;
+        }
+        glUseProgram(planarProgram);
+        glUniform1i(glGetUniformLocation(planarProgram, "interleaved"), livePlanarLayout == PixelLayout::NV12);
+        planarTexture.bind();
+    } else {
+        if (frameDirty) {
+            StageTimer timer(governor, GovernorStage::UPLOAD);
+            textureManager.updateTexture(frameBuffer);
+        }
+        glUseProgram(shaderProgram);
+        textureManager.bind();
+    }
     glBindVertexArray(VAO);
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
     glBindVertexArray(0);
-    textureManager.unbind();
+    if (planarDisplay) {
+        planarTexture.unbind();
+    } else {
+        textureManager.unbind();
+    }
 
     renderImGui();
 
@@ -435,37 +1087,33 @@ void VIApp::drawFiltersPanel() {
     ImGui::SetNextWindowSize(ImVec2(180, 0), ImGuiCond_Always);
     ImGui::Begin("Filters", nullptr, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoCollapse);
 
-    std::vector<FilterInfo> filters = filterManager.getAvailableFilters();
-    std::string currentLabel = "Sem filtro";
-    for (const auto& info : filters) {
-        if (info.type == currentFilter) {
-            currentLabel = info.name;
-            break;
-        }
-    }
+    const FilterList& filters = filterManager.getAvailableFilters();
+    const FilterInfo& current = filterInfo(currentFilter);
 
-    if (ImGui::BeginCombo("##Filter", currentLabel.c_str())) {
+    if (ImGui::BeginCombo("##Filter", current.name)) {
         bool noneSelected = currentFilter == FilterType::NONE;
-        if (ImGui::Selectable("Sem filtro", noneSelected)) {
+        if (ImGui::Selectable(kNoFilterInfo.name, noneSelected)) {
             currentFilter = FilterType::NONE;
         }
         if (ImGui::IsItemHovered()) {
-            ImGui::SetTooltip("Sem efeito aplicado");
+            ImGui::SetTooltip("%s", kNoFilterInfo.description);
         }
 
         for (const auto& info : filters) {
             bool active = info.type == currentFilter;
-            if (ImGui::Selectable(info.name.c_str(), active)) {
+            if (ImGui::Selectable(info.name, active)) {
                 currentFilter = info.type;
             }
             if (ImGui::IsItemHovered()) {
-                ImGui::SetTooltip("%s", info.description.c_str());
+                ImGui::SetTooltip("%s", info.description);
             }
         }
         ImGui::EndCombo();
     }
 
-    if (currentFilter == FilterType::RGB_CHANNELS) {
+    ImGui::Checkbox("Live previews", &filterPreviewsEnabled);
+
+    if (filterInfo(currentFilter).params & PARAM_RGB_TOGGLES) {
         ImGui::Separator();
         if (ImGui::Checkbox("R", &enableR)) {
             filterManager.setRGBChannels(enableR, enableG, enableB);
@@ -563,6 +1211,10 @@ void VIApp::drawPhotoHud() {
         ImGui::EndTable();
     }
 
+    if (progressiveRenderer.isRefining()) {
+        ImGui::TextDisabled("Refining...");
+    }
+
     ImGui::End();
 
     ImGui::SetNextWindowPos(ImVec2(WINDOW_WIDTH / 2 - 50, WINDOW_HEIGHT - 100), ImGuiCond_Always);
@@ -570,7 +1222,7 @@ void VIApp::drawPhotoHud() {
     ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0, 0));
     ImGui::Begin("Capture", nullptr, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoScrollbar);
     if (centeredButton("CAPTURE", ImVec2(80, 70))) {
-        saveCurrentImage();
+        captureRequested = true;
     }
     ImGui::End();
 
@@ -593,7 +1245,74 @@ void VIApp::drawVideoHud() {
         switchMode();
     }
     ImGui::End();
+
+    ImGui::SetNextWindowPos(ImVec2(15, WINDOW_HEIGHT - 85), ImGuiCond_Always);
+    ImGui::SetNextWindowSize(ImVec2(70, 0), ImGuiCond_Always);
+    ImGui::Begin("Record", nullptr, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoScrollbar);
+    bool recording = videoRecorder.isRecording();
+    ImGui::PushStyleColor(ImGuiCol_Button, recording ? ImVec4(0.8f, 0.1f, 0.1f, 1.0f) : ImVec4(0.35f, 0.1f, 0.1f, 1.0f));
+    if (centeredButton(recording ? "STOP" : "REC", ImVec2(50, 50))) {
+        setRecording(!recording);
+    }
+    ImGui::PopStyleColor();
+    ImGui::End();
+
+    if (retroSeconds > 0.0) {
+        ImGui::SetNextWindowPos(ImVec2(15, WINDOW_HEIGHT - 135), ImGuiCond_Always);
+        ImGui::SetNextWindowSize(ImVec2(70, 0), ImGuiCond_Always);
+        ImGui::Begin("Retro", nullptr, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoScrollbar);
+        char label[16];
+        snprintf(label, sizeof(label), "LAST %ds", static_cast<int>(retroSeconds + 0.5));
+        if (centeredButton(label, ImVec2(60, 35))) {
+            saveRetroWindow();
+        }
+        ImGui::End();
+    }
     ImGui::PopStyleVar();
+
+    if (webcamEnabled && videoHandler.isSeekable()) {
+        drawTimeline();
+    }
+}
+
+// Scrubbing and speed for sources of known length; every frame comes out of the decoded-frame cache
+void VIApp::drawTimeline() {
+    static const float kSpeeds[] = {-2.0f, -1.0f, -0.5f, 0.5f, 1.0f, 2.0f};
+    static const char* kSpeedLabels[] = {"-2x", "-1x", "-0.5x", "0.5x", "1x", "2x"};
+
+    ImGui::SetNextWindowPos(ImVec2(95, WINDOW_HEIGHT - 150), ImGuiCond_Always);
+    ImGui::SetNextWindowSize(ImVec2(WINDOW_WIDTH - 190, 0), ImGuiCond_Always);
+    ImGui::SetNextWindowBgAlpha(0.6f);
+    ImGui::Begin("Timeline", nullptr, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoScrollbar);
+
+    int count = static_cast<int>(videoHandler.getFrameCount());
+    int frame = static_cast<int>(std::max<int64_t>(0, videoHandler.getFrameIndex()));
+    double seconds = frame / videoHandler.getFPS();
+    char label[32];
+    snprintf(label, sizeof(label), "%02d:%05.2f", static_cast<int>(seconds) / 60, std::fmod(seconds, 60.0));
+    ImGui::SetNextItemWidth(WINDOW_WIDTH - 290);
+    if (ImGui::SliderInt("##timeline", &frame, 0, std::max(0, count - 1), label)) {
+        videoHandler.seek(frame);
+    }
+
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(70);
+    int current = 4;
+    for (int i = 0; i < 6; ++i) {
+        if (std::fabs(videoHandler.getSpeed() - kSpeeds[i]) < 1e-3) {
+            current = i;
+        }
+    }
+    if (ImGui::Combo("##speed", &current, kSpeedLabels, 6)) {
+        videoHandler.setSpeed(kSpeeds[current]);
+    }
+    if (ImGui::IsItemHovered()) {
+        const FrameCache* cache = videoHandler.getCache();
+        ImGui::SetTooltip("Cache: %d frames, %d MB\n%lld decoded, %lld seeks", cache->size(),
+                          static_cast<int>(cache->bytes() >> 20), static_cast<long long>(cache->decoded()),
+                          static_cast<long long>(cache->seeks()));
+    }
+    ImGui::End();
 }
 
 void VIApp::drawWebcamButton() {
@@ -608,8 +1327,16 @@ void VIApp::drawWebcamButton() {
     if (centeredButton(label, ImVec2(60, 60))) {
         webcamEnabled = !webcamEnabled;
         videoHandler.setPlaying(webcamEnabled);
+        if (!webcamEnabled && planarDisplay) {
+            // The frame on screen only exists as planes; the frozen frame needs it in BGR
+            frameBuffer = videoHandler.displayFrame();
+            planarDisplay = false;
+        }
         if (!webcamEnabled && !frameBuffer.empty()) {
+            ensureColorFrame();
             liveFrame = frameBuffer.clone();
+            liveSource.release();
+            ++liveFrameId;
         }
     }
     ImGui::PopStyleColor();
@@ -618,6 +1345,260 @@ void VIApp::drawWebcamButton() {
     ImGui::PopStyleVar();
 }
 
+// Scopes lag the picture by a frame or two; the textures are only re-uploaded when the worker has news
+void VIApp::drawScopesPanel() {
+    if (scopeAnalyzer.latest(scopeData)) {
+        waveformTexture.updateTexture(scopeData.waveform);
+        paradeTexture.updateTexture(scopeData.parade);
+    }
+
+    ImGui::SetNextWindowPos(ImVec2(WINDOW_WIDTH - 235, 130), ImGuiCond_Always);
+    ImGui::SetNextWindowSize(ImVec2(220, 0), ImGuiCond_Always);
+    ImGui::SetNextWindowBgAlpha(0.75f);
+    ImGui::Begin("Scopes", nullptr, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoCollapse);
+
+    ImVec2 plotSize(ImGui::GetContentRegionAvail().x, 50);
+    ImGui::PlotHistogram("##luma", scopeData.luma.data(), 256, 0, "Luma", 0.0f, 1.0f, plotSize);
+    ImGui::PushStyleColor(ImGuiCol_PlotLines, ImVec4(1.0f, 0.3f, 0.3f, 1.0f));
+    ImGui::PlotLines("##red", scopeData.red.data(), 256, 0, "R", 0.0f, 1.0f, ImVec2(plotSize.x, 30));
+    ImGui::PopStyleColor();
+    ImGui::PushStyleColor(ImGuiCol_PlotLines, ImVec4(0.3f, 1.0f, 0.3f, 1.0f));
+    ImGui::PlotLines("##green", scopeData.green.data(), 256, 0, "G", 0.0f, 1.0f, ImVec2(plotSize.x, 30));
+    ImGui::PopStyleColor();
+    ImGui::PushStyleColor(ImGuiCol_PlotLines, ImVec4(0.4f, 0.5f, 1.0f, 1.0f));
+    ImGui::PlotLines("##blue", scopeData.blue.data(), 256, 0, "B", 0.0f, 1.0f, ImVec2(plotSize.x, 30));
+    ImGui::PopStyleColor();
+
+    // TextureManager uploads flipped for the main quad, so the V coordinates are swapped here
+    if (!scopeData.waveform.empty()) {
+        ImGui::TextUnformatted("Waveform");
+        ImGui::Image((ImTextureID)(intptr_t)waveformTexture.getTextureID(), ImVec2(plotSize.x, 80), ImVec2(0, 1), ImVec2(1, 0));
+        ImGui::TextUnformatted("RGB Parade");
+        ImGui::Image((ImTextureID)(intptr_t)paradeTexture.getTextureID(), ImVec2(plotSize.x, 80), ImVec2(0, 1), ImVec2(1, 0));
+    }
+    ImGui::Text("%.2f ms, 1/%d sampling", scopeData.computeMs, scopeData.stride);
+
+    ImGui::End();
+}
+
+void VIApp::drawCaptureStatus() {
+    int saving = captureRenderer.pending() + captureEncoder.pending();
+    bool recording = videoRecorder.isRecording();
+    bool finishing = videoRecorder.isFinishing();
+    bool retroSaving = retroCapture.isSaving();
+    bool streaming = frameSink.isActive();
+    if (!burstActive && saving == 0 && !recording && !finishing && !retroSaving && !streaming) {
+        return;
+    }
+    ImGui::SetNextWindowPos(ImVec2(WINDOW_WIDTH / 2 - 80, 15), ImGuiCond_Always);
+    ImGui::SetNextWindowSize(ImVec2(160, 0), ImGuiCond_Always);
+    ImGui::SetNextWindowBgAlpha(0.75f);
+    ImGui::Begin("CaptureStatus", nullptr, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoTitleBar);
+    if (burstActive) {
+        ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "BURST %d", burstCount);
+    }
+    if (recording) {
+        int seconds = static_cast<int>(videoRecorder.elapsed(glfwGetTime()));
+        ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "REC %02d:%02d", seconds / 60, seconds % 60);
+        if (videoRecorder.duplicated() > 0 || videoRecorder.dropped() > 0) {
+            ImGui::TextDisabled("%lld dup, %lld dropped", static_cast<long long>(videoRecorder.duplicated()),
+                                static_cast<long long>(videoRecorder.dropped()));
+        }
+    } else if (finishing) {
+        ImGui::TextDisabled("Finishing video...");
+    }
+    if (retroSaving) {
+        ImGui::TextDisabled("Saving last %ds...", static_cast<int>(retroSeconds + 0.5));
+    }
+    if (streaming) {
+        if (frameSink.isConnected()) {
+            ImGui::TextDisabled("OUT %lld frames", static_cast<long long>(frameSink.written()));
+        } else {
+            ImGui::TextDisabled("OUT waiting for reader");
+        }
+        if (frameSink.dropped() > 0) {
+            ImGui::TextDisabled("%lld dropped", static_cast<long long>(frameSink.dropped()));
+        }
+    }
+    if (saving > 0) {
+        ImGui::TextDisabled("Saving %d...", saving);
+    }
+    int dropped = captureEncoder.dropped();
+    if (dropped > 0) {
+        ImGui::TextDisabled("%d dropped", dropped);
+    }
+    ImGui::End();
+}
+
+// Previews follow the raw frame and the current settings, a few times per second at most
+void VIApp::updateFilterPreviews() {
+    if (!filterPreviewsEnabled || liveFrame.empty() || autotuner.isRunning()) {
+        return;
+    }
+    FilterParams params = pipelineParams();
+    uint64_t key = hashCombine(liveFrameId, FilterManager::hashParams(params));
+    if (params.faceMask) {
+        key = hashCombine(key, reinterpret_cast<uintptr_t>(params.faceMask.get()));
+    }
+    filterPreviews.submit(liveFrame, params, key, glfwGetTime());
+}
+
+// Every cell is a slice of one atlas texture; clicking one selects that filter
+void VIApp::drawFilterPreviews() {
+    filterPreviews.upload();
+    if (filterPreviews.texture() == 0) {
+        return;
+    }
+
+    cv::Size thumb = filterPreviews.thumbSize();
+    // Above the timeline when there is one
+    float top = WINDOW_HEIGHT - (videoHandler.isSeekable() ? 330.0f : 290.0f);
+    ImGui::SetNextWindowPos(ImVec2(15, top), ImGuiCond_Always);
+    ImGui::SetNextWindowSize(ImVec2(WINDOW_WIDTH - 30, 0), ImGuiCond_Always);
+    ImGui::SetNextWindowBgAlpha(0.75f);
+    ImGui::Begin("FilterPreviews", nullptr, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_HorizontalScrollbar);
+
+    int cells = filterPreviews.cellCount();
+    ImTextureID atlas = (ImTextureID)(intptr_t)filterPreviews.texture();
+    for (int cell = 0; cell < cells; ++cell) {
+        if (cell > 0) {
+            ImGui::SameLine();
+        }
+        FilterType filter = filterPreviews.filterAt(cell);
+        bool active = filter == currentFilter;
+        if (active) {
+            ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.9f, 0.7f, 0.1f, 1.0f));
+        }
+        // TextureManager uploads flipped, so V runs from 1 to 0
+        ImVec2 uv0(static_cast<float>(cell) / cells, 1.0f);
+        ImVec2 uv1(static_cast<float>(cell + 1) / cells, 0.0f);
+        ImGui::PushID(cell);
+        if (ImGui::ImageButton("##preview", atlas, ImVec2(static_cast<float>(thumb.width), static_cast<float>(thumb.height)), uv0, uv1)) {
+            currentFilter = filter;
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("%s", filterInfo(filter).name);
+        }
+        ImGui::PopID();
+        if (active) {
+            ImGui::PopStyleColor();
+        }
+    }
+    ImGui::End();
+}
+
+void VIApp::setGallery(bool open) {
+    galleryOpen = open;
+    if (open) {
+        gallery.refresh();
+    }
+}
+
+// Only the rows in view ask for thumbnails; everything else stays a file name until scrolled to
+void VIApp::drawGalleryPanel() {
+    gallery.beginFrame();
+
+    ImGui::SetNextWindowPos(ImVec2(20, 120), ImGuiCond_Always);
+    ImGui::SetNextWindowSize(ImVec2(WINDOW_WIDTH - 40, 560), ImGuiCond_Always);
+    ImGui::SetNextWindowBgAlpha(0.9f);
+    if (!ImGui::Begin("Gallery", &galleryOpen, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoCollapse)) {
+        ImGui::End();
+        return;
+    }
+
+    int count = gallery.size();
+    ImGui::Text("%d photos", count);
+    ImGui::SameLine();
+    if (ImGui::Button("Refresh")) {
+        gallery.refresh();
+    }
+    if (gallery.isScanning()) {
+        ImGui::SameLine();
+        ImGui::TextDisabled("Scanning...");
+    }
+    ImGui::TextDisabled("%d thumbnails cached, %.1f MB", gallery.cachedCount(), gallery.cacheBytes() / (1024.0 * 1024.0));
+
+    ImGui::BeginChild("##grid", ImVec2(0, 0));
+    // Fixed cells sized for portrait captures keep every row the same height for the clipper
+    float cellWidth = static_cast<float>(gallery.thumbWidth());
+    float cellHeight = cellWidth * WINDOW_HEIGHT / WINDOW_WIDTH;
+    float spacing = ImGui::GetStyle().ItemSpacing.x;
+    int columns = std::max(1, static_cast<int>((ImGui::GetContentRegionAvail().x + spacing) / (cellWidth + spacing)));
+    int rows = (count + columns - 1) / columns;
+
+    ImGuiListClipper clipper;
+    clipper.Begin(rows, cellHeight + ImGui::GetStyle().ItemSpacing.y);
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+            for (int column = 0; column < columns; ++column) {
+                int index = row * columns + column;
+                if (index >= count) {
+                    break;
+                }
+                if (column > 0) {
+                    ImGui::SameLine();
+                }
+                ImGui::PushID(index);
+                ImVec2 origin = ImGui::GetCursorPos();
+                cv::Size size;
+                GLuint texture = gallery.thumbnail(index, size);
+                if (texture != 0 && size.width > 0 && size.height > 0) {
+                    float scale = std::min(cellWidth / size.width, cellHeight / size.height);
+                    ImVec2 fit(size.width * scale, size.height * scale);
+                    ImGui::SetCursorPos(ImVec2(origin.x + (cellWidth - fit.x) / 2, origin.y + (cellHeight - fit.y) / 2));
+                    ImGui::Image((ImTextureID)(intptr_t)texture, fit, ImVec2(0, 1), ImVec2(1, 0));
+                    ImGui::SetCursorPos(origin);
+                }
+                ImGui::Dummy(ImVec2(cellWidth, cellHeight));
+                if (ImGui::IsItemHovered()) {
+                    ImGui::SetTooltip("%s", gallery.name(index).c_str());
+                }
+                ImGui::PopID();
+            }
+        }
+    }
+    clipper.End();
+    ImGui::EndChild();
+    ImGui::End();
+}
+
+// Collapsed to a one-line notice while quality is reduced; G expands it with the per-stage costs
+void VIApp::drawGovernorPanel() {
+    if (!governorPanel && governor.level() == 0) {
+        return;
+    }
+    ImGui::SetNextWindowPos(ImVec2(15, WINDOW_HEIGHT - 320), ImGuiCond_Always);
+    ImGui::SetNextWindowSize(ImVec2(240, 0), ImGuiCond_Always);
+    ImGui::SetNextWindowBgAlpha(0.75f);
+    ImGui::Begin("Governor", nullptr, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoTitleBar);
+
+    if (!governorPanel) {
+        ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.3f, 1.0f), "Reduced quality (level %d)", governor.level());
+        ImGui::End();
+        return;
+    }
+
+    ImGui::Text("Frame %.1f / %.1f ms", governor.frameMs(), governor.getBudget());
+    if (!governor.isEnabled()) {
+        ImGui::TextDisabled("Governor off");
+    }
+    for (int i = 0; i < static_cast<int>(GovernorStage::COUNT); ++i) {
+        GovernorStage stage = static_cast<GovernorStage>(i);
+        ImGui::Text("  %-8s %6.2f ms", FrameGovernor::stageName(stage), governor.stageMs(stage));
+    }
+    ImGui::Separator();
+    for (int i = 0; i < static_cast<int>(Degradation::COUNT); ++i) {
+        Degradation degradation = static_cast<Degradation>(i);
+        if (governor.active(degradation)) {
+            ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.3f, 1.0f), "%s", FrameGovernor::degradationName(degradation));
+        } else {
+            ImGui::TextDisabled("%s", FrameGovernor::degradationName(degradation));
+        }
+    }
+
+    ImGui::End();
+}
+
 void VIApp::renderImGui() {
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplGlfw_NewFrame();
@@ -632,6 +1613,17 @@ void VIApp::renderImGui() {
         drawVideoHud();
     }
     drawWebcamButton();
+    if (scopesEnabled) {
+        drawScopesPanel();
+    }
+    drawGovernorPanel();
+    drawCaptureStatus();
+    if (filterPreviewsEnabled) {
+        drawFilterPreviews();
+    }
+    if (galleryOpen) {
+        drawGalleryPanel();
+    }
 
     ImGui::Render();
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
@@ -647,25 +1639,58 @@ void VIApp::run() {
     lastFrameTime = glfwGetTime();
     
     while (!glfwWindowShouldClose(window)) {
+        // A few frames after the last change let ImGui settle, then block until input arrives; the
+        // timeout picks up results of background work that does not post events (scopes)
+        idleFrames = isIdle() ? idleFrames + 1 : 0;
+        if (idleFrames > 3) {
+            glfwWaitEventsTimeout(0.5);
+        } else {
+            glfwPollEvents();
+        }
+
+        // Clamped so resuming playback after a long wait does not decode a burst of frames
         double currentTime = glfwGetTime();
-        frameDelta = currentTime - lastFrameTime;
+        frameDelta = std::min(currentTime - lastFrameTime, 0.25);
         lastFrameTime = currentTime;
         
-        glfwPollEvents();
+        governor.beginFrame();
         processFrame();
+        captureBurstFrame();
+        captureRetroFrame();
+        updateFilterPreviews();
+        recordFrame();
         renderFrame();
+        if (frameDirty) {
+            governor.endFrame();
+        }
     }
 }
 
 void VIApp::cleanup() {
+    progressiveRenderer.stop();
+    videoRecorder.stop(true);
+    frameSink.stop();
+    retroCapture.stop();
+    gallery.stop();
+    filterPreviews.stop();
+    captureRenderer.stop();
+    captureEncoder.stop();
+    autotuner.stop();
+    scopeAnalyzer.stop();
     shutdownImGui();
     
     if (VAO) glDeleteVertexArrays(1, &VAO);
     if (VBO) glDeleteBuffers(1, &VBO);
     if (EBO) glDeleteBuffers(1, &EBO);
     if (shaderProgram) glDeleteProgram(shaderProgram);
+    if (planarProgram) glDeleteProgram(planarProgram);
     
     textureManager.cleanup();
+    planarTexture.cleanup();
+    waveformTexture.cleanup();
+    paradeTexture.cleanup();
+    gallery.cleanup();
+    filterPreviews.cleanup();
     
     if (window) {
         glfwDestroyWindow(window);
@@ -709,18 +1734,183 @@ void VIApp::cursorPosCallback(GLFWwindow* windowPtr, double xpos, double ypos) {
 }
 
 void VIApp::keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
-    if (!instance || action != GLFW_PRESS) return;
+    if (!instance) return;
+    // Burst capture runs while B is held
+    if (key == GLFW_KEY_B && action != GLFW_REPEAT) {
+        instance->setBurst(action == GLFW_PRESS);
+        return;
+    }
+    if (action != GLFW_PRESS) return;
     
     if (key == GLFW_KEY_ESCAPE) {
         glfwSetWindowShouldClose(window, true);
     } else if (key == GLFW_KEY_SPACE) {
         instance->resetImage();
         std::cout << "Reset to original" << std::endl;
+    } else if (key == GLFW_KEY_T) {
+        instance->setTemporalReuse(!instance->temporalReuseEnabled, instance->temporalReuse.getThreshold());
+        std::cout << "Temporal reuse " << (instance->temporalReuseEnabled ? "ON" : "OFF") << std::endl;
+    } else if (key == GLFW_KEY_R) {
+        instance->setRecording(!instance->videoRecorder.isRecording());
+    } else if (key == GLFW_KEY_L) {
+        instance->saveRetroWindow();
+    } else if (key == GLFW_KEY_P) {
+        instance->setGallery(!instance->galleryOpen);
+    } else if (key == GLFW_KEY_G) {
+        instance->governorPanel = !instance->governorPanel;
+    } else if (key == GLFW_KEY_H) {
+        instance->setScopes(!instance->scopesEnabled, instance->scopeAnalyzer.getBudget());
+        std::cout << "Scopes " << (instance->scopesEnabled ? "ON" : "OFF") << std::endl;
     }
 }
 
-int main() {
+int main(int argc, char** argv) {
+    IntermediatePrecision precision = IntermediatePrecision::FLOAT32;
+    bool tiling = true;
+    bool isaForced = false;
+    VIApp::AutotuneMode autotune = VIApp::AutotuneMode::AUTO;
+    bool reuse = false;
+    double reuseThreshold = 2.0;
+    bool scopes = false;
+    bool progressive = true;
+    bool governed = true;
+    double frameBudget = 0.0;
+    EncodeOptions encodeOptions;
+    RecordPolicy recordPolicy = RecordPolicy::DUPLICATE;
+    double retroSeconds = 5.0;
+    RetroFormat retroFormat = RetroFormat::CLIP;
+    AnimationOptions animationOptions;
+    double scopeBudget = 2.0;
+    std::string sourceSpec;
+    int frameCacheMb = 256;
+    Orientation orientation = Orientation::CCW90;
+    SinkOptions sinkOptions;
+    RecordPolicy sinkPolicy = RecordPolicy::DUPLICATE;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--precision=", 0) == 0) {
+            if (!parsePrecision(arg.substr(12), precision)) {
+                std::cerr << "Unknown precision '" << arg.substr(12) << "' (use fp32, fp16 or fixed16)" << std::endl;
+                return -1;
+            }
+        } else if (arg.rfind("--isa=", 0) == 0) {
+            CpuIsa isa;
+            if (!parseCpuIsa(arg.c_str() + 6, isa)) {
+                std::cerr << "Unknown ISA '" << arg.substr(6) << "' (use scalar, sse2, avx2 or avx512)" << std::endl;
+                return -1;
+            }
+            if (!forceCpuIsa(isa)) {
+                std::cerr << "ISA " << cpuIsaName(isa) << " is not supported here, keeping " << cpuIsaName(activeCpuIsa()) << std::endl;
+            }
+            isaForced = true;
+        } else if (arg.rfind("--source=", 0) == 0) {
+            sourceSpec = arg.substr(9);
+        } else if (arg.rfind("--orientation=", 0) == 0) {
+            if (!parseOrientation(arg.substr(14), orientation)) {
+                std::cerr << "Unknown orientation '" << arg.substr(14) << "' (use none, cw, ccw, 180 or auto)" << std::endl;
+                return -1;
+            }
+        } else if (arg.rfind("--frame-cache=", 0) == 0) {
+            if (!parseNumberOption(arg.substr(14), 0, std::numeric_limits<int>::max(), frameCacheMb)) {
+                std::cerr << "Invalid frame cache size '" << arg.substr(14) << "' (use megabytes >= 0)" << std::endl;
+                return -1;
+            }
+        } else if (arg == "--source-report") {
+            std::string spec = (i + 1 < argc) ? argv[i + 1] : "synthetic";
+            return runSourceReport(spec, 300, WINDOW_WIDTH, WINDOW_HEIGHT);
+        } else if (arg == "--isa-report") {
+            std::string image = (i + 1 < argc) ? argv[i + 1] : "";
+            return runIsaReport(image, WINDOW_WIDTH, WINDOW_HEIGHT);
+        } else if (arg == "--autotune") {
+            autotune = VIApp::AutotuneMode::FORCE;
+        } else if (arg == "--no-autotune") {
+            autotune = VIApp::AutotuneMode::OFF;
+        } else if (arg == "--temporal-reuse") {
+            reuse = true;
+        } else if (arg.rfind("--temporal-reuse=", 0) == 0) {
+            reuse = true;
+            if (!parseNumberOption(arg.substr(17), 0.0, false, reuseThreshold)) {
+                std::cerr << "Invalid temporal reuse threshold '" << arg.substr(17) << "' (use a number >= 0)" << std::endl;
+                return -1;
+            }
+        } else if (arg == "--scopes") {
+            scopes = true;
+        } else if (arg.rfind("--scopes=", 0) == 0) {
+            scopes = true;
+            if (!parseNumberOption(arg.substr(9), 0.0, true, scopeBudget)) {
+                std::cerr << "Invalid scope budget '" << arg.substr(9) << "' (use milliseconds > 0)" << std::endl;
+                return -1;
+            }
+        } else if (arg.rfind("--capture-format=", 0) == 0) {
+            if (!parseEncodeOptions(arg.substr(17), encodeOptions)) {
+                std::cerr << "Unknown capture format '" << arg.substr(17) << "' (use png[:0-9], jpeg[:0-100] or webp[:1-100|lossless])" << std::endl;
+                return -1;
+            }
+        } else if (arg.rfind("--record-policy=", 0) == 0) {
+            if (!parseRecordPolicy(arg.substr(16), recordPolicy)) {
+                std::cerr << "Unknown record policy '" << arg.substr(16) << "' (use duplicate or drop)" << std::endl;
+                return -1;
+            }
+        } else if (arg.rfind("--sink=", 0) == 0) {
+            if (!parseSinkOptions(arg.substr(7), sinkOptions)) {
+                std::cerr << "Unknown sink '" << arg.substr(7) << "' (use y4m:<target> or raw:<target>, target -, <path> or shm:<name>[:slots >= 2])" << std::endl;
+                return -1;
+            }
+        } else if (arg.rfind("--sink-policy=", 0) == 0) {
+            if (!parseRecordPolicy(arg.substr(14), sinkPolicy)) {
+                std::cerr << "Unknown sink policy '" << arg.substr(14) << "' (use duplicate or drop)" << std::endl;
+                return -1;
+            }
+        } else if (arg.rfind("--retro=", 0) == 0) {
+            if (!parseRetroOptions(arg.substr(8), retroSeconds, retroFormat)) {
+                std::cerr << "Unknown retro capture option '" << arg.substr(8) << "' (use seconds >= 0[:clip|burst|gif|webp])" << std::endl;
+                return -1;
+            }
+        } else if (arg.rfind("--anim-palette=", 0) == 0) {
+            if (!parsePaletteMode(arg.substr(15), animationOptions.palette)) {
+                std::cerr << "Unknown palette mode '" << arg.substr(15) << "' (use global or frame)" << std::endl;
+                return -1;
+            }
+        } else if (arg == "--no-dither") {
+            animationOptions.dither = false;
+        } else if (arg == "--no-governor") {
+            governed = false;
+        } else if (arg.rfind("--frame-budget=", 0) == 0) {
+            if (!parseNumberOption(arg.substr(15), 0.0, false, frameBudget)) {
+                std::cerr << "Invalid frame budget '" << arg.substr(15) << "' (use milliseconds, 0 for the display refresh)" << std::endl;
+                return -1;
+            }
+        } else if (arg == "--no-progressive") {
+            progressive = false;
+        } else if (arg == "--no-tiling") {
+            tiling = false;
+        } else if (arg == "--precision-report") {
+            std::string image = (i + 1 < argc) ? argv[i + 1] : "";
+            return runPrecisionReport(image, WINDOW_WIDTH, WINDOW_HEIGHT);
+        }
+    }
+
     VIApp app;
+    if (!sinkOptions.target.empty() && !app.setSink(sinkOptions, sinkPolicy)) {
+        return -1;
+    }
+    app.setPrecision(precision);
+    app.setTiledExecution(tiling);
+    app.setAutotuneMode(autotune);
+    app.setIsaPinned(isaForced);
+    app.setTemporalReuse(reuse, reuseThreshold);
+    app.setScopes(scopes, scopeBudget);
+    app.setProgressiveEditing(progressive);
+    app.setFrameGovernor(governed, frameBudget);
+    app.setEncodeOptions(encodeOptions);
+    app.setRecordPolicy(recordPolicy);
+    app.setRetroCapture(retroSeconds, retroFormat);
+    app.setAnimationOptions(animationOptions);
+    if (!sourceSpec.empty()) {
+        app.setSource(sourceSpec);
+    }
+    app.setFrameCache(static_cast<size_t>(frameCacheMb));
+    app.setOrientation(orientation);
     
     if (!app.initialize()) {
         std::cerr << "Failed to initialize application" << std::endl;
@@ -731,12 +1921,20 @@ int main() {
     std::cout << "Instagram-style camera interface" << std::endl;
     std::cout << "\nKeyboard Controls:" << std::endl;
     std::cout << "  SPACE - Reset filters and stickers" << std::endl;
+    std::cout << "  T     - Toggle temporal block reuse (video mode)" << std::endl;
+    std::cout << "  H     - Toggle histogram/waveform/parade scopes" << std::endl;
+    std::cout << "  G     - Show frame budget governor details" << std::endl;
+    std::cout << "  P     - Open/close the gallery of saved photos" << std::endl;
+    std::cout << "  B     - Hold for burst capture (one file per frame)" << std::endl;
+    std::cout << "  R     - Start/stop video recording" << std::endl;
+    std::cout << "  L     - Save the last seconds of video (retroactive capture)" << std::endl;
     std::cout << "  ESC   - Exit application" << std::endl;
     std::cout << "\nUI Controls:" << std::endl;
     std::cout << "  VIDEO MODE:" << std::endl;
     std::cout << "    - Use the dropdowns to select filters and overlays" << std::endl;
     std::cout << "    - Click PHOTO button to switch to photo mode" << std::endl;
     std::cout << "    - Click FACE button to toggle face detection" << std::endl;
+    std::cout << "    - Click REC button to record the processed video" << std::endl;
     std::cout << "  PHOTO MODE:" << std::endl;
     std::cout << "    - Click S1-S6 buttons to select stickers" << std::endl;
     std::cout << "    - Click on image to place selected sticker" << std::endl;
@@ -748,4 +1946,4 @@ int main() {
     app.cleanup();
     
     return 0;
-}
\ No newline at end of file
+}